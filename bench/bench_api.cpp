@@ -0,0 +1,40 @@
+#include "bench_api.h"
+#include <cmath>
+
+int add_i32(int a, int b) {
+  return a + b;
+}
+
+double scale_f64(double v, double factor) {
+  return v * factor;
+}
+
+bool is_even(int v) {
+  return (v & 1) == 0;
+}
+
+size_t string_length(std::string_view s) {
+  return s.size();
+}
+
+std::string echo_string(const std::string& s) {
+  return s;
+}
+
+double point_norm(Point p) {
+  return std::sqrt(p.x * p.x + p.y * p.y);
+}
+
+Point make_point(double x, double y) {
+  return Point{x, y, 0};
+}
+
+void point_translate(Point* p, double dx, double dy) {
+  if (!p) return;
+  p->x += dx;
+  p->y += dy;
+}
+
+Color next_color(Color c) {
+  return static_cast<Color>((static_cast<int>(c) + 1) % 3);
+}
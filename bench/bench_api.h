@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// 基准测试用 API：每类常见签名各取一个代表，
+// 同时由生成的绑定 (bench_api) 和手写绑定 (manual_bindings.cc) 导出
+
+#define BENCH_VERSION 3
+#define BENCH_NAME "qjs-bench"
+
+enum class Color {
+  RED = 0,
+  GREEN,
+  BLUE
+};
+
+struct Point {
+  double x;
+  double y;
+  int tag;
+};
+
+// --- 标量 ---
+int add_i32(int a, int b);
+double scale_f64(double v, double factor);
+bool is_even(int v);
+
+// --- 字符串 ---
+size_t string_length(std::string_view s);
+std::string echo_string(const std::string& s);
+
+// --- 结构体传值 / 返回值 ---
+double point_norm(Point p);
+Point make_point(double x, double y);
+
+// --- 结构体指针 (原地修改) ---
+void point_translate(Point* p, double dx, double dy);
+
+// --- 枚举 ---
+Color next_color(Color c);
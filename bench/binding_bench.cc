@@ -0,0 +1,315 @@
+#include "quickjs.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "bench_api_bind.h"
+#include "manual_bindings.h"
+
+// 生成绑定 (bench_api) 与手写绑定 (bench_manual) 的逐项对比：
+//   ns/call         JS 循环中每次调用的耗时 (已减去空循环开销)
+//   cxx_allocs/call 全局 operator new 次数
+//   js_allocs/call  QuickJS 堆分配次数 (JS_NewRuntime2 + 计数分配器)
+//   module_init     JS_NewCModule + 导入模块 (执行模块 init) 的耗时与分配次数
+// 用法: binding_bench [--json] [iterations=1000000]
+// --json 输出一个 JSON 数组，每行一个结果，便于 CI 比较回归
+
+namespace
+{
+  std::atomic<uint64_t> cxx_allocs{0};
+  uint64_t js_allocs = 0; // 每个 runtime 只在主线程使用
+
+  // 记录块大小，以便实现 js_malloc_usable_size
+  struct alignas(16) BlockHeader
+  {
+    size_t size;
+  };
+
+  void* counting_malloc(void* opaque, size_t size)
+  {
+    ++js_allocs;
+    BlockHeader* h = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + size));
+    if (!h) return nullptr;
+    h->size = size;
+    return h + 1;
+  }
+
+  void* counting_calloc(void* opaque, size_t count, size_t size)
+  {
+    if (size && count > SIZE_MAX / size) return nullptr;
+    void* p = counting_malloc(opaque, count * size);
+    if (p) std::memset(p, 0, count * size);
+    return p;
+  }
+
+  void counting_free(void* opaque, void* ptr)
+  {
+    if (ptr) std::free(static_cast<BlockHeader*>(ptr) - 1);
+  }
+
+  void* counting_realloc(void* opaque, void* ptr, size_t size)
+  {
+    if (!ptr) return counting_malloc(opaque, size);
+    if (size == 0)
+    {
+      counting_free(opaque, ptr);
+      return nullptr;
+    }
+    ++js_allocs;
+    BlockHeader* h = static_cast<BlockHeader*>(std::realloc(static_cast<BlockHeader*>(ptr) - 1, sizeof(BlockHeader) + size));
+    if (!h) return nullptr;
+    h->size = size;
+    return h + 1;
+  }
+
+  size_t counting_usable_size(const void* ptr)
+  {
+    return ptr ? (static_cast<const BlockHeader*>(ptr) - 1)->size : 0;
+  }
+
+  JSRuntime* new_counting_runtime()
+  {
+    JSMallocFunctions mf{};
+    mf.js_calloc = counting_calloc;
+    mf.js_malloc = counting_malloc;
+    mf.js_free = counting_free;
+    mf.js_realloc = counting_realloc;
+    mf.js_malloc_usable_size = counting_usable_size;
+    return JS_NewRuntime2(&mf, nullptr);
+  }
+}
+
+void* operator new(size_t size)
+{
+  cxx_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace
+{
+  using ModuleInit = JSModuleDef* (*)(JSContext*, const char*);
+
+  struct Binding
+  {
+    const char* name;
+    ModuleInit init;
+  };
+
+  const Binding kBindings[] = {
+    { "generated", js_init_module_bench_api },
+    { "manual", js_init_module_bench_manual },
+  };
+
+  struct Case
+  {
+    const char* name;
+    const char* expr; // 循环体，可使用 m / i / s16 / s1k / p
+  };
+
+  const Case kCases[] = {
+    { "scalar_i32", "m.add_i32(i, 1)" },
+    { "scalar_f64", "m.scale_f64(i, 0.5)" },
+    { "scalar_bool", "m.is_even(i)" },
+    { "string_view_arg_16", "m.string_length(s16)" },
+    { "string_view_arg_1k", "m.string_length(s1k)" },
+    { "string_roundtrip_16", "m.echo_string(s16)" },
+    { "string_roundtrip_1k", "m.echo_string(s1k)" },
+    { "struct_by_value_arg", "m.point_norm(p)" },
+    { "struct_by_value_return", "m.make_point(i, 1)" },
+    { "struct_by_pointer", "m.point_translate(p, 1, 1)" },
+    { "struct_field_get", "p.x" },
+    { "struct_field_set", "p.tag = i" },
+    { "enum_roundtrip", "m.next_color(m.Color.GREEN)" },
+    { "macro_read", "m.BENCH_VERSION" },
+  };
+
+  const char kModuleName[] = "bench";
+  const char kImport[] = "import * as m from 'bench';\nglobalThis.m = m;\n";
+  const char kSetup[] =
+    "globalThis.s16 = 'x'.repeat(16);\n"
+    "globalThis.s1k = 'x'.repeat(1024);\n"
+    "globalThis.p = m.make_point(3, 4);\n";
+
+  struct Result
+  {
+    std::string binding;
+    std::string name;
+    long iterations;
+    double ns;
+    double cxx_allocs;
+    double js_allocs;
+  };
+
+  void dump_exception(JSContext* ctx, const char* what)
+  {
+    JSValue exc = JS_GetException(ctx);
+    const char* msg = JS_ToCString(ctx, exc);
+    std::fprintf(stderr, "%s failed: %s\n", what, msg ? msg : "exception");
+    JS_FreeCString(ctx, msg);
+    JS_FreeValue(ctx, exc);
+  }
+
+  bool eval(JSContext* ctx, const char* code, int flags, const char* what)
+  {
+    JSValue r = JS_Eval(ctx, code, std::strlen(code), "<bench>", flags);
+    bool ok = !JS_IsException(r);
+    if (!ok) dump_exception(ctx, what);
+    JS_FreeValue(ctx, r);
+    return ok;
+  }
+
+  // 计时 + 计数区间
+  struct Probe
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t cxx = cxx_allocs.load(std::memory_order_relaxed);
+    uint64_t js = js_allocs;
+
+    Result finish(const char* binding, const char* name, long n) const
+    {
+      double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      return { binding, name, n, ns / n, double(cxx_allocs.load(std::memory_order_relaxed) - cxx) / n,
+               double(js_allocs - js) / n };
+    }
+  };
+
+  // 每个 context 新建并导入模块，模块 init 在导入时执行
+  bool bench_module_init(const Binding& b, long count, std::vector<Result>& out)
+  {
+    JSRuntime* rt = new_counting_runtime();
+    std::vector<JSContext*> contexts;
+    for (long i = 0; i < count; ++i) contexts.push_back(JS_NewContext(rt));
+
+    bool ok = true;
+    Probe probe;
+    for (JSContext* ctx : contexts)
+      if (!b.init(ctx, kModuleName) || !eval(ctx, kImport, JS_EVAL_TYPE_MODULE, "import"))
+      {
+        ok = false;
+        break;
+      }
+    if (ok) out.push_back(probe.finish(b.name, "module_init", count));
+
+    for (JSContext* ctx : contexts) JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    return ok;
+  }
+
+  // 编译 (n) => { for (...) { expr; } } 并调用一次，返回 n 次迭代的结果
+  bool run_loop(JSContext* ctx, const char* binding, const char* name, const char* expr, long n, Result* result)
+  {
+    std::string src = std::string("(function (n) { for (let i = 0; i < n; i++) { ") + expr + "; } })";
+    JSValue fn = JS_Eval(ctx, src.c_str(), src.size(), name, JS_EVAL_TYPE_GLOBAL);
+    if (JS_IsException(fn))
+    {
+      dump_exception(ctx, name);
+      return false;
+    }
+    JSValue warm = JS_NewInt64(ctx, std::max(n / 100, 1L));
+    JSValue count = JS_NewInt64(ctx, n);
+    JSValue r = JS_Call(ctx, fn, JS_UNDEFINED, 1, &warm);
+    bool ok = !JS_IsException(r);
+    JS_FreeValue(ctx, r);
+    if (ok)
+    {
+      JS_RunGC(JS_GetRuntime(ctx));
+      Probe probe;
+      r = JS_Call(ctx, fn, JS_UNDEFINED, 1, &count);
+      *result = probe.finish(binding, name, n);
+      ok = !JS_IsException(r);
+      JS_FreeValue(ctx, r);
+    }
+    if (!ok) dump_exception(ctx, name);
+    JS_FreeValue(ctx, fn);
+    return ok;
+  }
+
+  bool bench_calls(const Binding& b, long n, std::vector<Result>& out)
+  {
+    JSRuntime* rt = new_counting_runtime();
+    JSContext* ctx = JS_NewContext(rt);
+    bool ok = b.init(ctx, kModuleName) && eval(ctx, kImport, JS_EVAL_TYPE_MODULE, "import") &&
+              eval(ctx, kSetup, JS_EVAL_TYPE_GLOBAL, "setup");
+
+    Result loop{};
+    ok = ok && run_loop(ctx, b.name, "loop_overhead", "", n, &loop);
+    if (ok) out.push_back(loop);
+    for (const Case& c : kCases)
+    {
+      Result r{};
+      if (!(ok = ok && run_loop(ctx, b.name, c.name, c.expr, n, &r))) break;
+      r.ns = std::max(0.0, r.ns - loop.ns);
+      r.cxx_allocs -= loop.cxx_allocs;
+      r.js_allocs -= loop.js_allocs;
+      out.push_back(r);
+    }
+
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    return ok;
+  }
+
+  void print_text(const std::vector<Result>& results)
+  {
+    std::printf("%-10s %-24s %12s %14s %14s\n", "binding", "case", "ns/call", "cxx_allocs", "js_allocs");
+    for (const Result& r : results)
+      std::printf("%-10s %-24s %12.1f %14.2f %14.2f\n", r.binding.c_str(), r.name.c_str(), r.ns, r.cxx_allocs,
+                  r.js_allocs);
+  }
+
+  void print_json(const std::vector<Result>& results)
+  {
+    std::printf("[\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      const Result& r = results[i];
+      std::printf("  {\"binding\": \"%s\", \"case\": \"%s\", \"iterations\": %ld, \"ns_per_call\": %.3f, "
+                  "\"cxx_allocs_per_call\": %.3f, \"js_allocs_per_call\": %.3f}%s\n",
+                  r.binding.c_str(), r.name.c_str(), r.iterations, r.ns, r.cxx_allocs, r.js_allocs,
+                  i + 1 < results.size() ? "," : "");
+    }
+    std::printf("]\n");
+  }
+}
+
+int main(int argc, const char* argv[])
+{
+  bool json = false;
+  long iterations = 1000000;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--json") == 0) json = true;
+    else iterations = std::max(std::strtol(argv[i], nullptr, 10), 1L);
+  }
+  long contexts = std::clamp(iterations / 500, 10L, 2000L);
+
+  std::vector<Result> results;
+  for (const Binding& b : kBindings)
+  {
+    if (!bench_module_init(b, contexts, results) || !bench_calls(b, iterations, results))
+    {
+      std::fprintf(stderr, "%s: benchmark aborted\n", b.name);
+      return 1;
+    }
+  }
+
+  if (json) print_json(results);
+  else print_text(results);
+  return 0;
+}
@@ -0,0 +1,36 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+// 生成一个大头文件 (structs 个结构体，每个 fields 个字段，类型轮换)，
+// 用来衡量生成代码的编译时间和目标文件大小
+// 用法: large_api_gen <out.h> [structs=60] [fields=30]
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "usage: large_api_gen <out.h> [structs] [fields]\n";
+    return 1;
+  }
+  int structs = argc > 2 ? std::atoi(argv[2]) : 60;
+  int fields = argc > 3 ? std::atoi(argv[3]) : 30;
+  const char* types[] = {"int", "double", "bool", "std::string", "LargeMode", "LargeRecord0*", "uint32_t", "float"};
+  const int typeCount = sizeof(types) / sizeof(types[0]);
+
+  std::ofstream out(argv[1]);
+  out << "#pragma once\n\n#include <cstdint>\n#include <string>\n\n";
+  out << "enum class LargeMode {\n  A = 0,\n  B,\n  C\n};\n\n";
+  out << "struct LargeRecord0;\n";
+  for (int i = 0; i < structs; ++i)
+  {
+    out << "\nstruct LargeRecord" << i << " {\n";
+    for (int j = 0; j < fields; ++j) out << "  " << types[(i + j) % typeCount] << " f" << j << ";\n";
+    out << "};\n";
+  }
+  out << "\n";
+  for (int i = 0; i < structs; ++i)
+    out << "inline int large_touch_" << i << "(LargeRecord" << i << "* r) { return r ? 1 : 0; }\n";
+  return out ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+#include "manual_bindings.h"
+#include <string>
+#include "bench_api.h"
+
+// 手工优化的对照实现：直接调用 JS_To* / JS_New*，不经过任何模板，
+// 数值函数走 JS_CFUNC_f_f_f，字段访问用带 magic 的 getset，宏导出为 int32 常量
+
+namespace
+{
+  JSClassID point_class_id;
+
+  void point_finalizer(JSRuntime* rt, JSValue val)
+  {
+    delete static_cast<Point*>(JS_GetOpaque(val, point_class_id));
+  }
+
+  Point* unwrap_point(JSContext* ctx, JSValueConst val)
+  {
+    return static_cast<Point*>(JS_GetOpaque2(ctx, val, point_class_id));
+  }
+
+  JSValue wrap_point(JSContext* ctx, const Point& p)
+  {
+    JSValue obj = JS_NewObjectClass(ctx, point_class_id);
+    if (JS_IsException(obj)) return obj;
+    JS_SetOpaque(obj, new Point(p));
+    return obj;
+  }
+
+  JSValue point_ctor(JSContext* ctx, JSValueConst new_target, int argc, JSValueConst* argv)
+  {
+    return wrap_point(ctx, Point{});
+  }
+
+  JSValue point_get(JSContext* ctx, JSValueConst this_val, int magic)
+  {
+    Point* p = unwrap_point(ctx, this_val);
+    if (!p) return JS_EXCEPTION;
+    switch (magic)
+    {
+      case 0: return JS_NewFloat64(ctx, p->x);
+      case 1: return JS_NewFloat64(ctx, p->y);
+      default: return JS_NewInt32(ctx, p->tag);
+    }
+  }
+
+  JSValue point_set(JSContext* ctx, JSValueConst this_val, JSValueConst val, int magic)
+  {
+    Point* p = unwrap_point(ctx, this_val);
+    if (!p) return JS_EXCEPTION;
+    int rc;
+    switch (magic)
+    {
+      case 0: rc = JS_ToFloat64(ctx, &p->x, val); break;
+      case 1: rc = JS_ToFloat64(ctx, &p->y, val); break;
+      default: rc = JS_ToInt32(ctx, &p->tag, val); break;
+    }
+    return rc ? JS_EXCEPTION : JS_UNDEFINED;
+  }
+
+  const JSCFunctionListEntry point_proto_funcs[] = {
+    JS_CGETSET_MAGIC_DEF("x", point_get, point_set, 0),
+    JS_CGETSET_MAGIC_DEF("y", point_get, point_set, 1),
+    JS_CGETSET_MAGIC_DEF("tag", point_get, point_set, 2),
+  };
+
+  JSValue js_add_i32(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    int32_t a, b;
+    if (JS_ToInt32(ctx, &a, argv[0]) || JS_ToInt32(ctx, &b, argv[1])) return JS_EXCEPTION;
+    return JS_NewInt32(ctx, add_i32(a, b));
+  }
+
+  JSValue js_is_even(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    int32_t v;
+    if (JS_ToInt32(ctx, &v, argv[0])) return JS_EXCEPTION;
+    return JS_NewBool(ctx, is_even(v));
+  }
+
+  JSValue js_string_length(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    size_t len;
+    const char* s = JS_ToCStringLen(ctx, &len, argv[0]);
+    if (!s) return JS_EXCEPTION;
+    size_t r = string_length(std::string_view(s, len));
+    JS_FreeCString(ctx, s);
+    return JS_NewInt64(ctx, static_cast<int64_t>(r));
+  }
+
+  JSValue js_echo_string(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    size_t len;
+    const char* s = JS_ToCStringLen(ctx, &len, argv[0]);
+    if (!s) return JS_EXCEPTION;
+    std::string r = echo_string(std::string(s, len));
+    JS_FreeCString(ctx, s);
+    return JS_NewStringLen(ctx, r.data(), r.size());
+  }
+
+  JSValue js_point_norm(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    Point* p = unwrap_point(ctx, argv[0]);
+    if (!p) return JS_EXCEPTION;
+    return JS_NewFloat64(ctx, point_norm(*p));
+  }
+
+  JSValue js_make_point(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    double x, y;
+    if (JS_ToFloat64(ctx, &x, argv[0]) || JS_ToFloat64(ctx, &y, argv[1])) return JS_EXCEPTION;
+    return wrap_point(ctx, make_point(x, y));
+  }
+
+  JSValue js_point_translate(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    Point* p = unwrap_point(ctx, argv[0]);
+    double dx, dy;
+    if (!p || JS_ToFloat64(ctx, &dx, argv[1]) || JS_ToFloat64(ctx, &dy, argv[2])) return JS_EXCEPTION;
+    point_translate(p, dx, dy);
+    return JS_UNDEFINED;
+  }
+
+  JSValue js_next_color(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    int32_t c;
+    if (JS_ToInt32(ctx, &c, argv[0])) return JS_EXCEPTION;
+    return JS_NewInt32(ctx, static_cast<int32_t>(next_color(static_cast<Color>(c))));
+  }
+
+  const JSCFunctionListEntry bench_manual_funcs[] = {
+    JS_CFUNC_DEF("add_i32", 2, js_add_i32),
+    JS_CFUNC_SPECIAL_DEF("scale_f64", 2, f_f_f, scale_f64),
+    JS_CFUNC_DEF("is_even", 1, js_is_even),
+    JS_CFUNC_DEF("string_length", 1, js_string_length),
+    JS_CFUNC_DEF("echo_string", 1, js_echo_string),
+    JS_CFUNC_DEF("point_norm", 1, js_point_norm),
+    JS_CFUNC_DEF("make_point", 2, js_make_point),
+    JS_CFUNC_DEF("point_translate", 3, js_point_translate),
+    JS_CFUNC_DEF("next_color", 1, js_next_color),
+    JS_PROP_INT32_DEF("BENCH_VERSION", BENCH_VERSION, JS_PROP_CONFIGURABLE),
+    JS_PROP_STRING_DEF("BENCH_NAME", BENCH_NAME, JS_PROP_CONFIGURABLE),
+  };
+
+  int bench_manual_init(JSContext* ctx, JSModuleDef* m)
+  {
+    JSRuntime* rt = JS_GetRuntime(ctx);
+    JS_NewClassID(rt, &point_class_id);
+    if (!JS_IsRegisteredClass(rt, point_class_id))
+    {
+      JSClassDef def = { "Point", .finalizer = point_finalizer };
+      if (JS_NewClass(rt, point_class_id, &def) < 0) return -1;
+    }
+    JSValue proto = JS_NewObject(ctx);
+    JS_SetPropertyFunctionList(ctx, proto, point_proto_funcs, sizeof(point_proto_funcs) / sizeof(JSCFunctionListEntry));
+    JS_SetClassProto(ctx, point_class_id, proto);
+    JSValue ctor = JS_NewCFunction2(ctx, point_ctor, "Point", 0, JS_CFUNC_constructor, 0);
+    JS_SetConstructor(ctx, ctor, proto);
+    JS_SetModuleExport(ctx, m, "Point", ctor);
+
+    JSValue color = JS_NewObject(ctx);
+    JS_DefinePropertyValueStr(ctx, color, "RED", JS_NewInt32(ctx, 0), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, color, "GREEN", JS_NewInt32(ctx, 1), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, color, "BLUE", JS_NewInt32(ctx, 2), JS_PROP_C_W_E);
+    JS_SetModuleExport(ctx, m, "Color", color);
+
+    return JS_SetModuleExportList(ctx, m, bench_manual_funcs, sizeof(bench_manual_funcs) / sizeof(JSCFunctionListEntry));
+  }
+}
+
+JSModuleDef* js_init_module_bench_manual(JSContext* ctx, const char* module_name)
+{
+  JSModuleDef* m = JS_NewCModule(ctx, module_name, bench_manual_init);
+  if (!m) return nullptr;
+  JS_AddModuleExportList(ctx, m, bench_manual_funcs, sizeof(bench_manual_funcs) / sizeof(JSCFunctionListEntry));
+  JS_AddModuleExport(ctx, m, "Point");
+  JS_AddModuleExport(ctx, m, "Color");
+  return m;
+}
@@ -0,0 +1,5 @@
+#pragma once
+#include "quickjs.h"
+
+// 手写的 bench_api.h 绑定，导出与生成模块完全相同的名字，供 binding_bench 对照
+JSModuleDef* js_init_module_bench_manual(JSContext* ctx, const char* module_name);
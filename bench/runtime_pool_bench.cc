@@ -0,0 +1,193 @@
+#include "quickjs.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_api_bind.h"
+#include "qjs_runtime_pool.hpp"
+
+// QJSRuntimePool 的吞吐量：1 ~ 64 个工作线程各自循环 acquire() -> 调用 JS 函数 -> 归还，
+// 每个请求在 JS 中调用若干次生成的绑定 (bench_api)。
+//   requests/s  所有线程合计的请求吞吐量
+//   us/request  单个请求的平均墙钟耗时 (含等待空闲引擎)
+//   wait%       acquire() 需要等待的比例
+//   start_ms    pool.start() 并行初始化全部 runtime 的耗时
+// 用法: runtime_pool_bench [--json] [--runtimes=N] [--recycle=N] [--max_threads=64] [requests=20000]
+// 默认 runtime 数 = 线程数；--runtimes 固定池大小，用来观察线程多于 runtime 时的排队
+
+namespace
+{
+  struct BenchModule; // 模块模板槽位
+
+  const char kSetup[] =
+    "import * as m from 'bench';\n"
+    "globalThis.work = function (k) {\n"
+    "  let acc = 0;\n"
+    "  for (let i = 0; i < 32; i++) acc += m.add_i32(i, k) + m.point_norm(m.make_point(i, k));\n"
+    "  return acc + m.string_length(m.echo_string('request'));\n"
+    "};\n";
+
+  struct Options
+  {
+    bool json = false;
+    size_t runtimes = 0; // 0 = 与线程数相同
+    size_t recycle = 0;
+    size_t max_threads = 64;
+    long requests = 20000; // 每个线程数档位的请求总数
+  };
+
+  struct Result
+  {
+    size_t threads;
+    size_t runtimes;
+    long requests;
+    double start_ms;
+    double requests_per_sec;
+    double us_per_request;
+    double wait_pct;
+    uint64_t recycled;
+  };
+
+  void dump_exception(JSContext* ctx, const char* what)
+  {
+    JSValue exc = JS_GetException(ctx);
+    const char* msg = JS_ToCString(ctx, exc);
+    std::fprintf(stderr, "%s failed: %s\n", what, msg ? msg : "exception");
+    JS_FreeCString(ctx, msg);
+    JS_FreeValue(ctx, exc);
+  }
+
+  bool setup_context(JSContext* ctx)
+  {
+    JSValue r = JS_Eval(ctx, kSetup, std::strlen(kSetup), "<setup>", JS_EVAL_TYPE_MODULE);
+    bool ok = !JS_IsException(r);
+    if (!ok) dump_exception(ctx, "setup");
+    JS_FreeValue(ctx, r);
+    return ok;
+  }
+
+  // 一个请求：在租到的 context 中调用 work(k)
+  bool serve(JSContext* ctx, int k)
+  {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue fn = JS_GetPropertyStr(ctx, global, "work");
+    JSValue arg = JS_NewInt32(ctx, k);
+    JSValue r = JS_Call(ctx, fn, JS_UNDEFINED, 1, &arg);
+    bool ok = !JS_IsException(r);
+    if (!ok) dump_exception(ctx, "work");
+    JS_FreeValue(ctx, r);
+    JS_FreeValue(ctx, fn);
+    JS_FreeValue(ctx, global);
+    return ok;
+  }
+
+  bool bench_threads(const Options& opt, size_t threads, Result* result)
+  {
+    size_t runtimes = opt.runtimes ? opt.runtimes : threads;
+    QJSRuntimePool pool(QJSRuntimePool::Options{}.with_runtimes(runtimes).with_recycle_after(opt.recycle));
+    pool.add_module<BenchModule>("bench", js_init_module_bench_api).on_context(setup_context);
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (!pool.start())
+    {
+      std::fprintf(stderr, "%zu runtimes: pool start failed\n", runtimes);
+      return false;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    // 请求按计数器分发，线程数多时每个线程分到的请求更少
+    std::atomic<long> next{0};
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t)
+      workers.emplace_back([&]
+      {
+        for (long i; (i = next.fetch_add(1, std::memory_order_relaxed)) < opt.requests;)
+        {
+          auto lease = pool.acquire();
+          if (!lease || !serve(lease.ctx(), int(i & 0xff)))
+          {
+            failed = true;
+            return;
+          }
+        }
+      });
+    for (auto& w : workers) w.join();
+    auto t2 = std::chrono::steady_clock::now();
+    if (failed) return false;
+
+    double secs = std::chrono::duration<double>(t2 - t1).count();
+    QJSRuntimePool::Stats stats = pool.stats();
+    *result = { threads,
+                runtimes,
+                opt.requests,
+                std::chrono::duration<double, std::milli>(t1 - t0).count(),
+                opt.requests / secs,
+                secs * 1e6 * threads / opt.requests,
+                stats.leases ? 100.0 * stats.waits / stats.leases : 0.0,
+                stats.recycled };
+    return true;
+  }
+
+  void print_text(const std::vector<Result>& results)
+  {
+    std::printf("%8s %9s %10s %14s %12s %8s %9s\n", "threads", "runtimes", "start_ms", "requests/s", "us/request",
+                "wait%", "recycled");
+    for (const Result& r : results)
+      std::printf("%8zu %9zu %10.1f %14.0f %12.2f %8.1f %9llu\n", r.threads, r.runtimes, r.start_ms,
+                  r.requests_per_sec, r.us_per_request, r.wait_pct, (unsigned long long)r.recycled);
+  }
+
+  void print_json(const std::vector<Result>& results)
+  {
+    std::printf("[\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      const Result& r = results[i];
+      std::printf("  {\"threads\": %zu, \"runtimes\": %zu, \"requests\": %ld, \"start_ms\": %.3f, "
+                  "\"requests_per_sec\": %.1f, \"us_per_request\": %.3f, \"wait_pct\": %.2f, \"recycled\": %llu}%s\n",
+                  r.threads, r.runtimes, r.requests, r.start_ms, r.requests_per_sec, r.us_per_request, r.wait_pct,
+                  (unsigned long long)r.recycled, i + 1 < results.size() ? "," : "");
+    }
+    std::printf("]\n");
+  }
+
+  size_t size_flag(const char* arg, const char* name)
+  {
+    return std::max<long>(std::strtol(arg + std::strlen(name), nullptr, 10), 1L);
+  }
+}
+
+int main(int argc, const char* argv[])
+{
+  Options opt;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--json") == 0) opt.json = true;
+    else if (std::strncmp(argv[i], "--runtimes=", 11) == 0) opt.runtimes = size_flag(argv[i], "--runtimes=");
+    else if (std::strncmp(argv[i], "--recycle=", 10) == 0) opt.recycle = size_flag(argv[i], "--recycle=");
+    else if (std::strncmp(argv[i], "--max_threads=", 14) == 0) opt.max_threads = size_flag(argv[i], "--max_threads=");
+    else opt.requests = std::max(std::strtol(argv[i], nullptr, 10), 1L);
+  }
+
+  std::vector<Result> results;
+  for (size_t threads = 1; threads <= opt.max_threads; threads *= 2)
+  {
+    Result r{};
+    if (!bench_threads(opt, threads, &r))
+    {
+      std::fprintf(stderr, "%zu threads: benchmark aborted\n", threads);
+      return 1;
+    }
+    results.push_back(r);
+  }
+
+  if (opt.json) print_json(results);
+  else print_text(results);
+  return 0;
+}
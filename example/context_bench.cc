@@ -0,0 +1,68 @@
+#include "quickjs.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "my_api_bind.h"
+
+// 每秒可创建的 context 数量（每个 context 都导入 my_api 模块）
+// 对比: 裸 context / js_init_module_my_api / js_init_module_my_api_from_template
+// 用法: context_bench [contexts=20000]
+
+namespace
+{
+  using ModuleInit = JSModuleDef* (*)(JSContext*, const char*);
+
+  const char kScript[] = "import * as api from 'my_api';\nglobalThis.sink = api.add(1, 2);\n";
+
+  bool import_module(JSContext* ctx)
+  {
+    JSValue r = JS_Eval(ctx, kScript, std::strlen(kScript), "<bench>", JS_EVAL_TYPE_MODULE);
+    bool ok = !JS_IsException(r);
+    if (!ok)
+    {
+      JSValue exc = JS_GetException(ctx);
+      const char* msg = JS_ToCString(ctx, exc);
+      std::fprintf(stderr, "import failed: %s\n", msg ? msg : "exception");
+      JS_FreeCString(ctx, msg);
+      JS_FreeValue(ctx, exc);
+    }
+    JS_FreeValue(ctx, r);
+    return ok;
+  }
+
+  // init == nullptr: context creation only, no module.
+  double contexts_per_sec(JSRuntime* rt, ModuleInit init, long count)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < count; ++i)
+    {
+      JSContext* ctx = JS_NewContext(rt);
+      if (init && (!init(ctx, "my_api") || !import_module(ctx)))
+      {
+        JS_FreeContext(ctx);
+        return 0;
+      }
+      JS_FreeContext(ctx);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return count / secs;
+  }
+}
+
+int main(int argc, const char* argv[])
+{
+  long count = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 20000;
+
+  JSRuntime* rt = JS_NewRuntime();
+  std::printf("%ld contexts per mode\n", count);
+  std::printf("%-28s %10.0f contexts/s\n", "bare context", contexts_per_sec(rt, nullptr, count));
+  std::printf("%-28s %10.0f contexts/s\n", "js_init_module", contexts_per_sec(rt, js_init_module_my_api, count));
+  std::printf("%-28s %10.0f contexts/s\n", "js_init_module_from_template",
+              contexts_per_sec(rt, js_init_module_my_api_from_template, count));
+
+  js_release_module_template_my_api(rt);
+  JS_FreeRuntime(rt);
+  return 0;
+}
@@ -2,6 +2,13 @@
 #include "quickjs-libc.h"
 #include <iostream>
 #include "my_api_bind.h"
+#include "qjs_utils.hpp"
+
+// 演示用：JS 侧读取调用结束后仍被保留的 C 回调数量
+static JSValue js_kept_callbacks(JSContext* ctx, JSValueConst, int, JSValueConst*)
+{
+  return JS_NewInt64(ctx, static_cast<int64_t>(qjs_callbacks_kept(ctx)));
+}
 
 int main(int argc, const char* argv[])
 {
@@ -12,7 +19,13 @@ int main(int argc, const char* argv[])
   js_std_add_helpers(ctx, argc, const_cast<char**>(argv));
   js_std_init_handlers(rt);
 
+  js_init_module_os(ctx, "os");
   js_init_module_my_api(ctx, "my_api");
+  JSValue global = JS_GetGlobalObject(ctx);
+  JS_SetPropertyStr(ctx, global, "__keptCallbacks", JS_NewCFunction(ctx, js_kept_callbacks, "__keptCallbacks", 0));
+  JS_FreeValue(ctx, global);
+  // 让 js_std_loop 等待并结算 *_async 调用
+  qjs_async_attach_std_loop(ctx);
 
   const char* js_code = R"(
         import * as api from 'my_api';
@@ -23,6 +36,13 @@ int main(int argc, const char* argv[])
             // --- 1. 基础函数 ---
             console.log("1. Add(10, 20) =", api.add(10, 20));
             api.log_message("Hello from JS Log");
+            // 在工作线程中执行，返回 Promise
+            api.log_message_async("Hello from a worker thread").then(() => console.log("   log_message_async settled"));
+            console.log("   count_lines =", api.count_lines("a\nb\nc"), "to_upper =", api.to_upper("quickjs"));
+            console.log("   distance(3, 4) =", api.distance(3, 4), "length =", api.distance.length);
+            console.log("   describe:", api.describe(7), "|", api.describe(2.5), "|", api.describe("x"));
+            // 批量调用：一次原生调用处理整个 TypedArray，数字参数会广播
+            console.log("   multiply_batch =", Array.from(api.multiply_batch(new Int32Array([1, 2, 3, 4]), 10)));
 
             // --- 2. 结构体传值测试 ---
             console.log("\n\x1b[33m--- Struct Pass-by-Value Test ---\x1b[0m");
@@ -58,9 +78,118 @@ int main(int argc, const char* argv[])
                 console.log("\x1b[31m[FAIL] Pointer modification NOT reflected!\x1b[0m");
             }
 
+            // 借用 / 共享返回：同一个 C++ 对象可以被多次返回，GC 不会 delete 它
+            let admin = api.find_user(1);
+            api.find_user(1).score += 1;
+            console.log(`Borrowed user [${admin.name}] score: ${admin.score}`);
+            let shared = api.shared_config();
+            shared.port += 1;
+            console.log("Shared config port:", shared.port, "seen by C++ too:", api.shared_config().port === shared.port);
+
             // --- 5. Boost.JSON 序列化 ---
             console.log("\n\x1b[33m--- Boost.JSON Serialization ---\x1b[0m");
             console.log("User JSON:", user.toJson());
+            console.log("User Object:", JSON.stringify(user.toObject()));
+            // 一次原生调用批量写入 / 读取全部字段
+            user.assign({ name: "Bulk", score: 77 });
+            console.log("User snapshot after assign:", JSON.stringify(user.snapshot()));
+            let copy = api.User.fromBuffer(user.toBuffer());
+            console.log("User fromBuffer(toBuffer()):", copy.name, copy.score);
+            // 畸形缓冲区必须被拒绝：不能从字节伪造 owner 指针，bool 字节只能是 0 / 1
+            let member = new api.Membership();
+            member.id = 7;
+            member.active = true;
+            member.owner = user;
+            let mbuf = member.toBuffer();
+            let forged = new Uint8Array(mbuf.byteLength + 8);
+            forged.set(new Uint8Array(mbuf));
+            forged.fill(0x41, mbuf.byteLength);
+            let badBool = Uint8Array.from(new Uint8Array(mbuf));
+            badBool[4] = 2;
+            const rejected = (buf) => {
+                try { api.Membership.fromBuffer(buf); return false; } catch (e) { return e instanceof RangeError; }
+            };
+            let restored = api.Membership.fromBuffer(mbuf);
+            if (mbuf.byteLength === 5 && restored.id === 7 && restored.active && !restored.owner &&
+                rejected(forged) && rejected(badBool)) {
+                console.log("\x1b[32m[SUCCESS] Malformed Membership buffers rejected, owner never encoded\x1b[0m");
+            } else {
+                console.log("\x1b[31m[FAIL] Membership fromBuffer accepted a malformed buffer!\x1b[0m");
+            }
+            // toObject 借用 owner：临时对象被回收时不能释放 user 的存储 (否则下一个 User 会复用它)
+            let ownerSeen = member.toObject().owner.name === user.name;
+            let fresh = new api.User();
+            fresh.name = "Fresh";
+            if (ownerSeen && user.name === "Bulk" && member.owner.name === "Bulk") {
+                console.log("\x1b[32m[SUCCESS] Membership toObject borrows owner\x1b[0m");
+            } else {
+                console.log("\x1b[31m[FAIL] Membership toObject released owner!\x1b[0m");
+            }
+            // 嵌套字段是父对象存储的视图：不复制，写入直接落到 dep 上
+            let dep = new api.Deployment();
+            let inner = dep.config;
+            inner.port = 8080;
+            console.log("Nested field write-through:", dep.config.port === 8080);
+            // snapshot 复制嵌套结构体：之后对 dep 的写入不会出现在快照里 (toObject 返回视图)
+            let snap = dep.snapshot();
+            let view = dep.toObject();
+            dep.config.port = 1234;
+            if (snap.config.port === 8080 && view.config.port === 1234) {
+                console.log("\x1b[32m[SUCCESS] snapshot copies nested structs, toObject views them\x1b[0m");
+            } else {
+                console.log("\x1b[31m[FAIL] snapshot follows later writes!\x1b[0m");
+            }
+            // assign 把普通对象写入嵌套结构体的各个字段，其余字段保持不变；无法转换的值抛出 TypeError
+            dep.config.host = "cluster";
+            dep.assign({ config: { port: 3000 }, replicas: 2 });
+            let badNested = false;
+            try { dep.assign({ config: 5 }); } catch (e) { badNested = e instanceof TypeError; }
+            if (dep.config.port === 3000 && dep.config.host === "cluster" && dep.replicas === 2 && badNested) {
+                console.log("\x1b[32m[SUCCESS] assign merges plain objects into nested structs\x1b[0m");
+            } else {
+                console.log("\x1b[31m[FAIL] assign reset a nested struct!\x1b[0m");
+            }
+            // 构造函数重载与成员函数：直接经成员函数指针调用
+            let counter = new api.Counter("clicks", 5);
+            counter.increment(2);
+            counter.increment(); // 默认参数 step = 1
+            counter.settings().port = 9000;
+            console.log("Counter:", counter.describe(), api.Counter.starting_at(3).describe(),
+                        "settings view:", counter.settings().port === 9000);
+
+            // --- 6. 零拷贝缓冲区 ---
+            console.log("\n\x1b[33m--- Zero-Copy Buffers ---\x1b[0m");
+            let ramp = api.make_ramp(5);
+            console.log("make_ramp(5) =", ramp.constructor.name, Array.from(ramp));
+            console.log("sum_samples(ramp) =", api.sum_samples(ramp));
+            let bytes = new Uint8Array(4);
+            api.fill_bytes(bytes, 7);
+            console.log("fill_bytes(Uint8Array(4), 7) =", Array.from(bytes));
+            console.log("count_words =", JSON.stringify(api.count_words(["a", "b", "a"])));
+
+            // --- 7. 回调 ---
+            console.log("\n\x1b[33m--- Callbacks ---\x1b[0m");
+            api.run_steps(3, (done, total) => console.log(`   progress ${done}/${total}`));
+            // 直接回调在调用返回时释放：循环调用不会累积；QJS_RETAINED 的回调保留到传入 null
+            const kept = __keptCallbacks();
+            for (let i = 0; i < 100; ++i) api.run_steps(1, () => {});
+            const flat = __keptCallbacks() === kept;
+            let handled = 0;
+            api.set_progress_handler((done) => { handled = done; });
+            api.emit_progress(2, 3);
+            const retained = handled === 2 && __keptCallbacks() === kept + 1;
+            api.set_progress_handler(null);
+            if (flat && retained && __keptCallbacks() === kept) {
+                console.log("\x1b[32m[SUCCESS] Direct callbacks released per call, retained ones kept until null\x1b[0m");
+            } else {
+                console.log("\x1b[31m[FAIL] Callback registrations leaked or dropped!\x1b[0m");
+            }
+            console.log("   count_matching(10, even) =", api.count_matching(10, (i) => i % 2 === 0));
+            // 工作线程产生的 5 个事件只进入 JS 一次
+            api.start_ticker(5, (events) => {
+                console.log(`   ticker: ${events.length} events in one batch`, JSON.stringify(events));
+                api.start_ticker(0, null); // 注销后 js_std_loop 才能退出
+            });
 
         } catch(e) {
             console.log("\x1b[31mJS Error Caught:\x1b[0m", e);
@@ -84,6 +213,10 @@ int main(int argc, const char* argv[])
   }
 
   JS_FreeValue(ctx, val);
+  js_std_loop(ctx);
+  qjs_callbacks_release(ctx);
+  // 等待仍在运行的 *_async 调用，并在 runtime 仍完整时释放它们持有的 JS 值
+  qjs_async_release(rt);
   std::cout << std::flush;
   std::cerr << std::flush;
   js_std_free_handlers(rt);
@@ -1,5 +1,7 @@
 #include "my_api.h"
 #include <iostream>
+#include <cmath>
+#include <thread>
 
 // ANSI 颜色码
 #define RESET   "\033[0m"
@@ -22,6 +24,23 @@ void log_message(const std::string& msg) {
   std::cout << MAGENTA << "[LOG] " << msg << RESET << std::endl;
 }
 
+size_t count_lines(std::string_view text) {
+  size_t n = 0;
+  for (char c : text)
+    if (c == '\n') n++;
+  return text.empty() || text.back() == '\n' ? n : n + 1;
+}
+
+std::string to_upper(std::string&& text) {
+  for (char& c : text)
+    if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+  return std::move(text);
+}
+
+double distance(double x, double y) noexcept {
+  return std::sqrt(x * x + y * y);
+}
+
 // 1. 接收结构体
 void print_config(Config cfg) {
   std::cout << CYAN << "[C++] Received Config: "
@@ -57,4 +76,96 @@ User* create_user(const std::string& name, int id) {
   u->id = id;
   u->score = 0;
   return u;
-}
\ No newline at end of file
+}
+
+// 借用返回：用户表归 C++ 所有
+User* find_user(int id) {
+  static User registry[] = {{1, "admin", 100}, {2, "guest", 0}};
+  for (User& u : registry)
+    if (u.id == id) return &u;
+  return nullptr;
+}
+
+// 共享返回
+std::shared_ptr<Config> shared_config() {
+  static std::shared_ptr<Config> cfg = std::make_shared<Config>(Config{8080, "0.0.0.0", false});
+  return cfg;
+}
+
+// 5. 指针 + 长度
+float sum_samples(const float* samples, size_t count) {
+  float total = 0.0f;
+  for (size_t i = 0; i < count; ++i) total += samples[i];
+  return total;
+}
+
+// 6. 原地修改
+void fill_bytes(uint8_t* data, size_t len, int value) {
+  for (size_t i = 0; i < len; ++i) data[i] = static_cast<uint8_t>(value);
+}
+
+// 7. 返回 vector
+std::vector<float> make_ramp(int n) {
+  std::vector<float> v(n > 0 ? n : 0);
+  for (int i = 0; i < n; ++i) v[i] = static_cast<float>(i);
+  return v;
+}
+
+std::string describe(int value) {
+  return "int " + std::to_string(value);
+}
+
+std::string describe(double value) {
+  return "double " + std::to_string(value);
+}
+
+std::string describe(const std::string& value) {
+  return "string " + value;
+}
+
+int Counter::instances = 0;
+
+std::string Counter::describe() const {
+  return label + "=" + std::to_string(value);
+}
+
+std::map<std::string, int> count_words(const std::vector<std::string>& words) {
+  std::map<std::string, int> counts;
+  for (const auto& w : words) counts[w]++;
+  return counts;
+}
+
+// 8. C 风格回调
+void run_steps(int steps, progress_cb on_progress, void* user_data) {
+  for (int i = 1; i <= steps; ++i)
+    if (on_progress) on_progress(user_data, i, steps);
+}
+
+static progress_cb g_progress_handler = nullptr;
+static void* g_progress_user_data = nullptr;
+
+void set_progress_handler(progress_cb on_progress, void* user_data) {
+  g_progress_handler = on_progress;
+  g_progress_user_data = user_data;
+}
+
+void emit_progress(int done, int total) {
+  if (g_progress_handler) g_progress_handler(g_progress_user_data, done, total);
+}
+
+// 9. std::function 回调
+int count_matching(int limit, std::function<bool(int)> pred) {
+  int n = 0;
+  for (int i = 0; i < limit; ++i)
+    if (pred && pred(i)) n++;
+  return n;
+}
+
+// 10. 在工作线程中触发回调 (排队模式下不会直接进入 JS)
+void start_ticker(int ticks, progress_cb on_tick, void* user_data) {
+  if (!on_tick) return;
+  std::thread worker([=] {
+    for (int i = 1; i <= ticks; ++i) on_tick(user_data, i, ticks);
+  });
+  worker.join();
+}
@@ -1,7 +1,15 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <functional>
+#include "qjs_annotations.h"
 
 #define API_VERSION "3.1.4"
 #define MAX_USERS 100
@@ -19,6 +27,12 @@ struct Config {
   bool debug_mode;
 };
 
+// 嵌套结构体：config 以视图形式暴露，dep.config.port = 1 直接写入 dep
+struct Deployment {
+  Config config;
+  int replicas;
+};
+
 // 复杂结构体 (包含方法演示)
 struct User {
   int id;
@@ -26,6 +40,31 @@ struct User {
   int score;
 };
 
+// 含指针成员：toBuffer / fromBuffer 只编码 id 和 active，owner 从不写入或读出缓冲区
+struct Membership {
+  int id;
+  bool active;
+  User* owner;
+};
+
+// 带构造函数和成员函数的结构体：方法绑定到原型，new Counter(…) 按参数选择构造函数
+struct Counter {
+  std::string label;
+  int value;
+  static int instances; // 静态成员不是实例字段：不生成访问器，也不进入 toBuffer 布局
+
+  Counter() : value(0) { ++instances; }
+  explicit Counter(const std::string& label, int start = 0) : label(label), value(start) { ++instances; }
+
+  int increment(int step = 1) { return value += step; }
+  std::string describe() const;
+  Config& settings() { return config_; } // 返回内部字段的视图
+  static Counter starting_at(int start) { return Counter("preset", start); }
+
+private:
+  Config config_{};
+};
+
 // --- 普通函数 ---
 std::string get_server_name();
 
@@ -35,7 +74,21 @@ inline int add(int a, int b) {
   return a + b;
 }
 
-void log_message(const std::string& msg);
+QJS_ASYNC void log_message(const std::string& msg);
+
+// string_view 参数直接借用 JS 字符串缓冲区 (调用期间有效)，不复制
+size_t count_lines(std::string_view text);
+
+// 右值引用参数：转换出的 std::string 被移动进函数
+std::string to_upper(std::string&& text);
+
+// 纯数值 noexcept 函数：注册为 JS_CFUNC_f_f_f，由 QuickJS 直接做 ToNumber 并调用 (同 Math.hypot)
+double distance(double x, double y) noexcept;
+
+// 重载：同名函数合并为一个分发函数，按参数个数和 JS 值类型选择 (整数 -> int, 小数 -> double)
+std::string describe(int value);
+std::string describe(double value);
+std::string describe(const std::string& value);
 
 // --- [新增] 结构体交互演示 ---
 
@@ -48,5 +101,41 @@ Config create_default_config();
 // 3. 修改传入的结构体 (按指针传递，JS对象的内部C++指针被修改)
 void update_user_score(User* user, int new_score);
 
-// 4. 工厂函数
-User* create_user(const std::string& name, int id);
\ No newline at end of file
+// 4. 工厂函数 (返回的对象归 JS 所有，GC 时 delete)
+User* create_user(const std::string& name, int id);
+
+// 借用返回：对象仍归 C++ 所有，JS 不会 delete，多次返回同一指针也安全
+QJS_BORROWED User* find_user(int id);
+
+// 共享返回：JS 对象持有 shared_ptr 引用计数，不复制
+std::shared_ptr<Config> shared_config();
+
+// --- 缓冲区 (零拷贝 ArrayBuffer / TypedArray) ---
+
+// 5. 指针 + 长度参数：JS 直接传入 Float32Array，不复制
+float sum_samples(const float* samples, size_t count);
+
+// 6. 原地修改 JS 缓冲区 (Uint8Array 内存被直接写入)
+void fill_bytes(uint8_t* data, size_t len, int value);
+
+// 7. 返回 vector：内存直接交给 JS ArrayBuffer
+std::vector<float> make_ramp(int n);
+
+// 非数值容器：vector<string> 由 JS 数组逐项转换，map 返回为普通对象
+std::map<std::string, int> count_words(const std::vector<std::string>& words);
+
+// --- 回调 ---
+
+// 8. C 风格回调：函数指针 + user_data，由生成的 trampoline 转发给 JS 函数
+typedef void (*progress_cb)(void* user_data, int done, int total);
+void run_steps(int steps, progress_cb on_progress, void* user_data);
+
+// 保存回调：调用返回后原生代码仍持有 on_progress (默认回调只在调用期间有效)，传入 null 注销
+QJS_RETAINED void set_progress_handler(progress_cb on_progress, void* user_data);
+void emit_progress(int done, int total);
+
+// 9. std::function 回调 (同步调用，JS 抛出的异常会传回调用方)
+int count_matching(int limit, std::function<bool(int)> pred);
+
+// 10. 排队模式：原生线程触发的事件在 JS 线程批量派发，传入 null 注销
+QJS_QUEUED void start_ticker(int ticks, progress_cb on_tick, void* user_data);
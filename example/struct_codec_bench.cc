@@ -0,0 +1,66 @@
+#include "quickjs.h"
+#include "quickjs-libc.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "my_api_bind.h"
+
+// 结构体导出路径对比：toJson + JSON.parse / toObject / toBuffer + fromBuffer
+// 用法: struct_codec_bench [iterations=200000]
+
+int main(int argc, const char* argv[])
+{
+  long iterations = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 200000;
+
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+  JS_SetModuleLoaderFunc(rt, nullptr, js_module_loader, nullptr);
+  js_std_add_helpers(ctx, argc, const_cast<char**>(argv));
+  js_std_init_handlers(rt);
+
+  js_init_module_my_api(ctx, "my_api");
+
+  std::string js_code = R"(
+        import * as api from 'my_api';
+
+        const N = )" + std::to_string(iterations) + R"(;
+        let user = api.create_user("benchmark-user", 42);
+        user.score = 1234;
+
+        function bench(label, fn) {
+            let sink = 0;
+            const start = performance.now();
+            for (let i = 0; i < N; i++) sink += fn();
+            const ms = performance.now() - start;
+            console.log(label.padEnd(26), (ms * 1e6 / N).toFixed(1).padStart(8), "ns/op", sink > 0 ? "" : "!");
+        }
+
+        console.log("User, " + N + " iterations");
+        bench("toJson + JSON.parse", () => JSON.parse(user.toJson()).score);
+        bench("toObject", () => user.toObject().score);
+        bench("toBuffer", () => user.toBuffer().byteLength);
+        bench("toBuffer + fromBuffer", () => api.User.fromBuffer(user.toBuffer()).score);
+    )";
+
+  JSValue val = JS_Eval(ctx, js_code.c_str(), js_code.size(), "<bench>", JS_EVAL_TYPE_MODULE);
+
+  if (JS_IsException(val)) {
+    js_std_dump_error(ctx);
+  } else if (JS_VALUE_GET_TAG(val) == JS_TAG_MODULE) {
+    if (JS_ResolveModule(ctx, val) < 0) {
+      js_std_dump_error(ctx);
+    } else {
+      JSValue ret = JS_EvalFunction(ctx, val);
+      if (JS_IsException(ret)) js_std_dump_error(ctx);
+      JS_FreeValue(ctx, ret);
+    }
+  }
+
+  JS_FreeValue(ctx, val);
+  js_std_free_handlers(rt);
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+  return 0;
+}
@@ -6,8 +6,47 @@ def _qjs_binding_impl(ctx):
     out_h = ctx.actions.declare_file(ctx.attr.module_name + "_bind.h")
     out_ts = ctx.actions.declare_file(ctx.attr.module_name + ".d.ts")  # <--- 新增这行
 
+    # 分片输出：每个分片一个 _bind_<i>.cpp，_bind.cpp 只负责模块注册
+    out_shards = [
+        ctx.actions.declare_file("%s_bind_%d.cpp" % (ctx.attr.module_name, i))
+        for i in range(ctx.attr.shards)
+    ]
+
+    headers = ([ctx.file.header] if ctx.file.header else []) + ctx.files.headers
+    if not headers:
+        fail("qjs_binding_gen: 至少需要指定 header 或 headers")
+
     args = ctx.actions.args()
-    args.add(ctx.file.header.path)
+
+    # 不使用对象池的结构体 (改用 new/delete)
+    for s in ctx.attr.no_pool_structs:
+        args.add("--no_pool=" + s)
+
+    # 第一个头文件作为位置参数，其余通过 --header= 传入
+    for h in headers[1:]:
+        args.add("--header=" + h.path)
+    if ctx.attr.shards > 0:
+        args.add("--shards=%d" % ctx.attr.shards)
+    if ctx.attr.lazy_init:
+        args.add("--lazy_init")
+
+    # 返回的指针归 C++ 所有 (等同于 QJS_BORROWED)
+    for f in ctx.attr.borrowed_returns:
+        args.add("--borrowed=" + f)
+
+    # 额外导出 <name>_async，在线程池中执行并返回 Promise (等同于 QJS_ASYNC)
+    for f in ctx.attr.async_functions:
+        args.add("--async=" + f)
+
+    # 回调在任意线程触发，事件排队后在 JS 线程批量派发 (等同于 QJS_QUEUED)
+    for f in ctx.attr.queued_callbacks:
+        args.add("--queued=" + f)
+
+    # 原生代码在调用返回后仍保存 C 回调 (等同于 QJS_RETAINED)
+    for f in ctx.attr.retained_callbacks:
+        args.add("--retained=" + f)
+
+    args.add(headers[0].path)
     args.add(out_cpp.dirname)
     args.add(ctx.attr.module_name)
 
@@ -16,9 +55,9 @@ def _qjs_binding_impl(ctx):
         args.add(inc)
 
     ctx.actions.run(
-        inputs = [ctx.file.header],
+        inputs = headers,
         # 2. 将 .d.ts 添加到 outputs 列表
-        outputs = [out_cpp, out_h, out_ts],  # <--- 修改这里
+        outputs = [out_cpp, out_h, out_ts] + out_shards,  # <--- 修改这里
         executable = ctx.executable._generator,
         arguments = [args],
         mnemonic = "QJSBindingGen",
@@ -27,14 +66,29 @@ def _qjs_binding_impl(ctx):
 
     # 3. 返回 DefaultInfo，这样 bazel build 才会真正生成它
     # 注意：cc_library 通常会忽略 .d.ts 文件，所以放在这里是安全的
-    return [DefaultInfo(files = depset([out_cpp, out_h, out_ts]))]
+    return [DefaultInfo(files = depset([out_cpp, out_h, out_ts] + out_shards))]
 
 qjs_binding_gen = rule(
     implementation = _qjs_binding_impl,
     attrs = {
-        "header": attr.label(allow_single_file = [".h", ".hpp"], mandatory = True),
+        "header": attr.label(allow_single_file = [".h", ".hpp"]),
+        # 多头文件输入，与 header 合并
+        "headers": attr.label_list(allow_files = [".h", ".hpp"], default = []),
+        # 分片数：0 表示生成单个 _bind.cpp；N > 0 时生成 N 个可并行编译的 _bind_<i>.cpp
+        "shards": attr.int(default = 0),
+        # 延迟初始化：结构体的 class 注册和 prototype 在首次使用时才创建
+        "lazy_init": attr.bool(default = False),
+        # 返回借用指针的函数名：JS 对象被回收时不会 delete
+        "borrowed_returns": attr.string_list(default = []),
+        # 异步函数名：生成返回 Promise 的 <name>_async
+        "async_functions": attr.string_list(default = []),
+        # 回调排队批量派发的函数名
+        "queued_callbacks": attr.string_list(default = []),
+        # C 回调在调用返回后仍被原生代码保存的函数名 (默认只在调用期间有效)
+        "retained_callbacks": attr.string_list(default = []),
         "module_name": attr.string(mandatory = True),
         "include_list": attr.string_list(default = []),
+        "no_pool_structs": attr.string_list(default = []),
         "_generator": attr.label(
             default = Label("@rules_quickjs_bind_gen//tools:qjs_bind_gen"),
             executable = True,
@@ -44,15 +98,38 @@ qjs_binding_gen = rule(
 )
 
 # 封装宏
-def qjs_cc_library(name, header, module_name, includes = [], include_list = [], deps = []):
+def qjs_cc_library(
+        name,
+        module_name,
+        header = None,
+        headers = [],
+        shards = 0,
+        lazy_init = False,
+        borrowed_returns = [],
+        async_functions = [],
+        queued_callbacks = [],
+        retained_callbacks = [],
+        includes = [],
+        include_list = [],
+        deps = [],
+        no_pool_structs = [],
+        copts = []):
     gen_name = name + "_gen"
     ts_target_name = name + "_ts"  # 新增一个 target名字
 
     qjs_binding_gen(
         name = gen_name,
         header = header,
+        headers = headers,
+        shards = shards,
+        lazy_init = lazy_init,
+        borrowed_returns = borrowed_returns,
+        async_functions = async_functions,
+        queued_callbacks = queued_callbacks,
+        retained_callbacks = retained_callbacks,
         module_name = module_name,
         include_list = include_list,
+        no_pool_structs = no_pool_structs,
     )
 
     # 用 js_library 包装生成的 .d.ts
@@ -66,11 +143,14 @@ def qjs_cc_library(name, header, module_name, includes = [], include_list = [],
     native.cc_library(
         name = name,
         srcs = [":" + gen_name],
-        hdrs = [":" + gen_name, header],
+        hdrs = [":" + gen_name] + ([header] if header else []) + headers,
         includes = includes,
+        # 例如 ["-fno-exceptions"]：qjs_utils.hpp 随之切换到 QJS_NO_EXCEPTIONS 模式
+        copts = copts,
         deps = deps + [
             "@quickjs-ng",
             "@boost.json",
+            "@rules_quickjs_bind_gen//tools:qjs_annotations",
             "@rules_quickjs_bind_gen//tools:qjs_utils",
         ],
         alwayslink = True,
@@ -0,0 +1,32 @@
+#pragma once
+
+// Binding annotations read by qjs_bind_gen. They expand to nothing for the compiler.
+//
+//   QJS_OWNED    User* create_user(...);  // JS owns the result, its finalizer deletes it (default)
+//   QJS_BORROWED User* find_user(int id); // C++ keeps ownership, JS never deletes it
+//
+// std::shared_ptr<T> results need no annotation: the JS object holds a reference.
+// The qjs_cc_library attribute `borrowed_returns` does the same as QJS_BORROWED for
+// headers that cannot be edited.
+//
+//   QJS_ASYNC    Report build_report(const std::string& q); // also exported as build_report_async
+//
+// `<name>_async` runs the call on a worker thread and returns a Promise (qjs_utils.hpp,
+// section 9). The attribute `async_functions` is the equivalent for unannotated headers.
+//
+//   QJS_QUEUED   void watch(int fd, event_cb cb, void* user_data); // cb may fire on any thread
+//
+// Callbacks passed to a QJS_QUEUED function only enqueue events; the JS function receives
+// them in batches on the JS thread (section 10). Attribute: `queued_callbacks`.
+//
+//   QJS_RETAINED void set_handler(event_cb cb, void* user_data); // native code keeps cb
+//
+// A C callback normally lives for the call only (run_steps-style APIs). QJS_RETAINED keeps
+// every registration until JS passes null through the same parameter or the host calls
+// qjs_callbacks_release(). Queued callbacks are always retained. Attribute: `retained_callbacks`.
+
+#define QJS_OWNED
+#define QJS_BORROWED
+#define QJS_ASYNC
+#define QJS_QUEUED
+#define QJS_RETAINED
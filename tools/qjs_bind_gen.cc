@@ -6,132 +6,271 @@
 #include <sstream>
 #include <map>
 #include <algorithm>
+#include <cctype>
 #include <boost/filesystem.hpp>
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
+#include "qjs_header_parser.hpp"
 
 namespace fs = boost::filesystem;
 
-struct GuardState
-{
-  std::string line;
-  std::string symbol;
-  bool isHeaderGuard;
-};
-
-struct FuncDef
-{
-  std::string retType, name, args;
-  std::vector<std::string> guards;
-};
-
-struct EnumDef
+struct ParamDef
 {
+  std::string type;
   std::string name;
-  std::vector<std::pair<std::string, std::string>> members;
-  std::vector<std::string> guards;
+  bool isArray = false;
+  bool hasDefault = false;
 };
 
-struct MacroDef
+// [New] A JS function parameter: a C function pointer (callback typedef or inline
+// `R (*f)(...)`) with its `void*` user-data parameter, or a std::function<R(...)>.
+struct CallbackParam
 {
-  std::string name, value;
-  std::vector<std::string> guards;
+  bool cPointer = false;
+  size_t userIndex = 0; // parameter carrying the C user data (cPointer only)
+  bool queued = false;  // events are batched onto the JS thread (void callbacks only)
+  std::string retType, args;
 };
 
-struct FieldDef
+// [New] One generated `<module>_bind_<i>.cpp` and the headers it has to include.
+struct Shard
 {
-  std::string type;
-  std::string name;
-};
-
-struct StructDef
-{
-  std::string name;
-  std::vector<FieldDef> fields;
-  std::vector<std::string> guards;
+  HeaderModel model;
+  std::vector<std::string> headers;
+  size_t weight = 0;
 };
 
 class BindingGenerator
 {
-  std::string inputPath;
+  std::vector<std::string> inputPaths;
   std::string outputDir;
   std::string moduleName;
   std::vector<std::string> extraIncludes;
+  std::set<std::string> noPoolStructs;
+  size_t shardCount = 0; // 0: one monolithic _bind.cpp
+  bool lazyInit = false;  // build struct classes on first use instead of at module init
+  std::set<std::string> borrowedReturns; // functions whose pointer result C++ keeps owning
+  std::set<std::string> asyncFunctions;  // also bound as `<name>_async`, run on the worker pool
+  std::set<std::string> queuedFunctions; // callbacks of these are queued and delivered in batches
+  std::set<std::string> retainedFunctions; // C callbacks of these outlive the call (native code keeps them)
+
+  // Property names referenced by generated code, interned once per runtime.
+  std::vector<std::string> atomNames;
+  std::map<std::string, size_t> atomIndex;
 
   std::vector<FuncDef> functions;
   std::vector<EnumDef> enums;
   std::vector<MacroDef> macros;
   std::vector<StructDef> structs;
+  std::vector<CallbackDef> callbacks;
+
+  // Per input header, in command-line order (used to plan shards).
+  std::vector<HeaderModel> headerModels;
 
 public:
-  BindingGenerator(std::string in, std::string out, std::string mod, std::vector<std::string> extras)
-    : inputPath(in), outputDir(out), moduleName(mod), extraIncludes(extras)
+  BindingGenerator(std::vector<std::string> in, std::string out, std::string mod, std::vector<std::string> extras,
+                   std::set<std::string> noPool = {}, size_t shards = 0, bool lazy = false,
+                   std::set<std::string> borrowed = {}, std::set<std::string> async = {},
+                   std::set<std::string> queued = {}, std::set<std::string> retained = {})
+    : inputPaths(in), outputDir(out), moduleName(mod), extraIncludes(extras), noPoolStructs(noPool),
+      shardCount(shards), lazyInit(lazy), borrowedReturns(borrowed), asyncFunctions(async),
+      queuedFunctions(queued), retainedFunctions(retained)
   {
   }
 
-  int evaluate_expression(std::string expr, const std::map<std::string, int>& symbolTable)
+  std::string strip_cv_ref(std::string type)
   {
-    expr.erase(std::remove(expr.begin(), expr.end(), ' '), expr.end());
-    if (expr.find('|') != std::string::npos)
+    boost::replace_all(type, "const", "");
+    boost::replace_all(type, "volatile", "");
+    boost::replace_all(type, "&", "");
+    boost::trim(type);
+    return type;
+  }
+
+  // Splits on `sep` outside of <>, () and [] so template arguments stay intact.
+  std::vector<std::string> split_top_level(const std::string& s, char sep)
+  {
+    std::vector<std::string> parts;
+    std::string cur;
+    int depth = 0;
+    for (char c : s)
     {
-      std::vector<std::string> parts;
-      boost::split(parts, expr, boost::is_any_of("|"));
-      int result = 0;
-      for (const auto& part : parts) result |= evaluate_expression(part, symbolTable);
-      return result;
+      if (c == '<' || c == '(' || c == '[') depth++;
+      else if ((c == '>' || c == ')' || c == ']') && depth > 0) depth--;
+      if (c == sep && depth == 0)
+      {
+        parts.push_back(cur);
+        cur.clear();
+        continue;
+      }
+      cur += c;
+    }
+    parts.push_back(cur);
+    return parts;
+  }
+
+  std::vector<ParamDef> parse_params(const std::string& rawArgs)
+  {
+    std::vector<ParamDef> params;
+    if (rawArgs.empty() || boost::trim_copy(rawArgs) == "void") return params;
+    static const boost::regex re_extract(R"((.*?)(?:\s+|[*&]+)([\w]+)(\[\])?$)");
+    static const std::set<std::string> type_words = {
+      "const", "unsigned", "signed", "struct", "enum", "int", "char", "short", "long", "float", "double", "bool"
+    };
+    int argCount = 0;
+    for (std::string argStr : split_top_level(rawArgs, ','))
+    {
+      boost::trim(argStr);
+      if (argStr.empty() || argStr == "void") continue;
+      size_t eq = argStr.find('=');
+      ParamDef p;
+      p.hasDefault = eq != std::string::npos;
+      if (p.hasDefault) argStr = boost::trim_copy(argStr.substr(0, eq)); // default argument
+      boost::smatch m;
+      static const boost::regex re_fnptr(R"((.*?)\(\s*\*\s*(\w+)\s*\)\s*(\(.*\)))");
+      if (boost::regex_match(argStr, m, re_fnptr))
+      {
+        p.name = m[2].str();
+        p.type = boost::trim_copy(m[1].str()) + " (*)" + m[3].str();
+      }
+      else if (boost::regex_match(argStr, m, re_extract) && !type_words.count(m[2].str()) &&
+        argStr.back() != '>')
+      {
+        p.name = m[2].str();
+        p.isArray = m[3].matched;
+        p.type = argStr.substr(0, argStr.rfind(p.name));
+      }
+      else
+      {
+        p.type = argStr;
+      }
+      boost::trim(p.type);
+      if (p.name.empty()) p.name = "arg" + std::to_string(argCount);
+      argCount++;
+      params.push_back(p);
     }
-    if (expr.length() > 2 && expr.front() == '(' && expr.back() == ')')
-      return evaluate_expression(
-        expr.substr(1, expr.length() - 2), symbolTable);
-    size_t shiftPos = expr.find("<<");
-    if (shiftPos != std::string::npos)
-      return evaluate_expression(expr.substr(0, shiftPos), symbolTable) <<
-        evaluate_expression(expr.substr(shiftPos + 2), symbolTable);
-    size_t plusPos = expr.find("+");
-    if (plusPos != std::string::npos)
-      return evaluate_expression(expr.substr(0, plusPos), symbolTable) +
-        evaluate_expression(expr.substr(plusPos + 1), symbolTable);
-    if (expr.find("0x") == 0 || expr.find("0X") == 0)
-      try { return std::stoul(expr, nullptr, 16); }
-      catch (...) { return 0; }
-    if (isdigit(expr[0]) || (expr.length() > 1 && expr[0] == '-'))
-      try { return std::stoi(expr); }
-      catch (...) { return 0; }
-    if (symbolTable.count(expr)) return symbolTable.at(expr);
-    return 0;
+    return params;
+  }
+
+  // [New] Element type of a pointer that can borrow TypedArray memory, e.g.
+  // "const float*" -> "const float", "void*" -> "uint8_t". Empty if not a buffer pointer.
+  std::string buffer_elem_type(const std::string& type)
+  {
+    std::string t = boost::trim_copy(type);
+    if (t.empty() || t.back() != '*') return "";
+    t = boost::trim_copy(t.substr(0, t.size() - 1));
+    if (t.find('*') != std::string::npos) return "";
+    bool isConst = t.find("const") != std::string::npos;
+    std::string base = strip_cv_ref(t);
+    static const std::set<std::string> elem_types = {
+      "float", "double", "int8_t", "uint8_t", "int16_t", "uint16_t", "int32_t", "uint32_t", "int64_t", "uint64_t",
+      "unsigned char", "signed char", "short", "unsigned short", "int", "unsigned int", "unsigned"
+    };
+    if (base == "void") base = "uint8_t";
+    else if (!elem_types.count(base)) return "";
+    return (isConst ? "const " : "") + base;
+  }
+
+  bool is_length_param(const ParamDef& p)
+  {
+    std::string t = strip_cv_ref(p.type);
+    if (t == "size_t" || t == "std::size_t") return true;
+    static const std::set<std::string> int_types = {
+      "int", "unsigned", "unsigned int", "uint32_t", "int32_t", "uint64_t", "int64_t", "long", "unsigned long"
+    };
+    if (!int_types.count(t)) return false;
+    std::string n = boost::to_lower_copy(p.name);
+    return n.find("len") != std::string::npos || n.find("size") != std::string::npos ||
+      n.find("count") != std::string::npos || n == "n";
   }
 
-  std::string remove_comments(const std::string& source)
+  // Index of every `T* data, size_t len` pair in `params`; the pair becomes one JS argument.
+  std::set<size_t> buffer_pairs(const std::vector<ParamDef>& params)
   {
-    try
+    std::set<size_t> pairs;
+    for (size_t i = 0; i + 1 < params.size(); ++i)
     {
-      boost::regex re_block(R"(/\*[\s\S]*?\*/)");
-      std::string temp = boost::regex_replace(source, re_block, "");
-      boost::regex re_line(R"(//[^\r\n]*)");
-      return boost::regex_replace(temp, re_line, "");
+      if (!buffer_elem_type(params[i].type).empty() && is_length_param(params[i + 1]))
+      {
+        pairs.insert(i);
+        ++i;
+      }
     }
-    catch (...) { return source; }
+    return pairs;
   }
 
-  std::string clean_type_string(std::string raw)
+  // TypedArray class matching a C++ element type ("" if none).
+  std::string ts_typed_array(std::string elem)
   {
-    boost::regex re_space(R"([\r\n\t]+)");
-    std::string s = boost::regex_replace(raw, re_space, " ");
-    boost::regex re_keywords(R"(\b(inline|static|constexpr|extern|virtual|explicit)\b)");
-    s = boost::regex_replace(s, re_keywords, "");
-    boost::regex re_multi_space(R"(\s+)");
-    s = boost::regex_replace(s, re_multi_space, " ");
-    return boost::regex_replace(s, boost::regex(R"(^\s+|\s+$)"), "");
+    elem = strip_cv_ref(elem);
+    static const std::map<std::string, std::string> arrays = {
+      {"float", "Float32Array"}, {"double", "Float64Array"},
+      {"int8_t", "Int8Array"}, {"signed char", "Int8Array"},
+      {"uint8_t", "Uint8Array"}, {"unsigned char", "Uint8Array"}, {"char", "Uint8Array"}, {"void", "Uint8Array"},
+      {"int16_t", "Int16Array"}, {"short", "Int16Array"},
+      {"uint16_t", "Uint16Array"}, {"unsigned short", "Uint16Array"},
+      {"int32_t", "Int32Array"}, {"int", "Int32Array"},
+      {"uint32_t", "Uint32Array"}, {"unsigned int", "Uint32Array"}, {"unsigned", "Uint32Array"},
+      {"int64_t", "BigInt64Array"}, {"uint64_t", "BigUint64Array"},
+    };
+    auto it = arrays.find(elem);
+    return it == arrays.end() ? "" : it->second;
   }
 
-  std::string clean_args_string(std::string raw)
+  // Inner type of `std::vector<T>` / `std::span<T>` / `QJSBufferView<T>` ("" otherwise).
+  std::string container_elem_type(const std::string& type)
   {
-    boost::regex re_space(R"([\r\n\t]+)");
-    return boost::regex_replace(raw, re_space, " ");
+    static const boost::regex re_container(R"(^(?:std::)?(?:vector|span|QJSBufferView)\s*<\s*(.+?)\s*(?:,.*)?>$)");
+    boost::smatch m;
+    std::string t = strip_cv_ref(type);
+    if (boost::regex_match(t, m, re_container)) return m[1].str();
+    return "";
+  }
+
+  // [New] Standard container type split into its kind and template arguments
+  // (`std::map<K, V>` -> {"map", K, V}); empty for anything else.
+  std::vector<std::string> std_container(const std::string& type)
+  {
+    static const boost::regex re_std(
+      R"(^(?:std::)?(vector|array|optional|map|unordered_map|pair)\s*<\s*(.*?)\s*>$)");
+    boost::smatch m;
+    std::string t = strip_cv_ref(type);
+    if (!boost::regex_match(t, m, re_std)) return {};
+    std::vector<std::string> parts{m[1].str()};
+    for (const auto& arg : split_top_level(m[2].str(), ',')) parts.push_back(boost::trim_copy(arg));
+    // std::array<T, N>: N is not a type
+    if (parts[0] == "array") parts.resize(2);
+    return parts;
+  }
+
+  // Numeric vectors / arrays come back as TypedArrays but also accept plain number arrays.
+  bool is_numeric_sequence(const std::string& type)
+  {
+    std::vector<std::string> c = std_container(type);
+    return !c.empty() && (c[0] == "vector" || c[0] == "array") && !ts_typed_array(c[1]).empty();
   }
 
   std::string cpp_to_ts_type(std::string cppType)
   {
+    std::vector<std::string> c = std_container(cppType);
+    if (!c.empty())
+    {
+      if (c[0] == "optional") return cpp_to_ts_type(c[1]) + " | null";
+      if (c[0] == "pair") return "[" + cpp_to_ts_type(c[1]) + ", " + cpp_to_ts_type(c[2]) + "]";
+      if (c[0] == "map" || c[0] == "unordered_map")
+        return std::string("Record<") + (cpp_to_ts_type(c[1]) == "string" ? "string" : "number") + ", " +
+          cpp_to_ts_type(c[2]) + ">";
+      std::string arr = ts_typed_array(c[1]);
+      if (!arr.empty()) return arr;
+      std::string elem = cpp_to_ts_type(c[1]);
+      return (elem.find(' ') != std::string::npos ? "(" + elem + ")" : elem) + "[]";
+    }
+    std::string elem = container_elem_type(cppType);
+    if (!elem.empty())
+    {
+      std::string arr = ts_typed_array(elem);
+      return arr.empty() ? "any[]" : arr;
+    }
     std::string t = cppType;
     boost::replace_all(t, "const", "");
     boost::replace_all(t, "volatile", "");
@@ -144,8 +283,17 @@ public:
       "int", "short", "long", "float", "double", "size_t", "uint8_t", "int8_t", "uint16_t", "int16_t", "uint32_t",
       "int32_t", "uint64_t", "int64_t", "unsigned int"
     };
+    // Whole-word match, so struct names such as "Point" are not taken for "int".
+    auto has_word = [&t](const std::string& w)
+    {
+      auto ident = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+      for (size_t pos = t.find(w); pos != std::string::npos; pos = t.find(w, pos + 1))
+        if ((pos == 0 || !ident(t[pos - 1])) && (pos + w.size() == t.size() || !ident(t[pos + w.size()])))
+          return true;
+      return false;
+    };
     for (const auto& nt : numTypes)
-      if (t.find(nt) != std::string::npos && t.find("*") == std::string::npos)
+      if (has_word(nt) && t.find("*") == std::string::npos)
         return
           "number";
     for (const auto& e : enums) if (t.find(e.name) != std::string::npos) return e.name;
@@ -153,80 +301,248 @@ public:
     return "any";
   }
 
-  std::string format_ts_args(const std::string& rawArgs)
+  // `optionalDefaults`: parameters with a default argument are optional (methods and statics,
+  // whose shorter forms are bound too).
+  std::string format_ts_args(const std::string& rawArgs, bool queued = false, bool optionalDefaults = false)
   {
-    if (rawArgs.empty() || rawArgs == "void") return "";
-    std::vector<std::string> args;
-    boost::split(args, rawArgs, boost::is_any_of(","));
+    std::vector<ParamDef> params = parse_params(rawArgs);
+    std::set<size_t> pairs = buffer_pairs(params);
+    std::map<size_t, CallbackParam> cbs = callback_params(params, queued);
+    std::set<size_t> userData;
+    for (const auto& [i, cb] : cbs)
+      if (cb.cPointer) userData.insert(cb.userIndex);
     std::stringstream ss;
-    int argCount = 0;
+    bool first = true;
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+      const ParamDef& p = params[i];
+      if (userData.count(i)) continue; // supplied by the trampoline
+      std::string tsType;
+      if (pairs.count(i)) tsType = ts_typed_array(buffer_elem_type(p.type)) + " | ArrayBuffer";
+      else if (cbs.count(i)) tsType = ts_callback_type(cbs[i]);
+      else tsType = cpp_to_ts_type(p.type);
+      if (is_numeric_sequence(p.type)) tsType += " | number[]";
+      if (p.isArray) tsType += "[]";
+      if (!first) ss << ", ";
+      first = false;
+      ss << p.name << (optionalDefaults && p.hasDefault ? "?: " : ": ") << tsType;
+      if (pairs.count(i)) ++i; // the length is taken from the buffer
+    }
+    return ss.str();
+  }
+
+  // JS type of a callback parameter; queued callbacks receive every pending event at once.
+  std::string ts_callback_type(const CallbackParam& cb)
+  {
+    std::vector<ParamDef> args = parse_params(cb.args);
+    size_t user = args.size(); // the trampoline keeps the last void* (C user data) to itself
+    for (size_t i = 0; cb.cPointer && i < args.size(); ++i)
+      if (is_void_pointer(args[i].type)) user = i;
+    std::stringstream sig, tuple;
+    bool first = true;
     for (size_t i = 0; i < args.size(); ++i)
     {
-      std::string argStr = args[i];
-      boost::trim(argStr);
-      if (argStr.empty() || argStr == "void") continue;
-      std::string type, name;
-      bool isArray = false;
-      boost::regex re_extract(R"((.*?)(?:\s+|[*&]+)([\w]+)(\[\])?$)");
-      boost::smatch m;
-      if (boost::regex_match(argStr, m, re_extract))
-      {
-        type = m[1].str();
-        name = m[2].str();
-        if (m[3].matched) isArray = true;
-        size_t namePos = argStr.rfind(name);
-        if (namePos != std::string::npos) type = argStr.substr(0, namePos);
-      }
-      else
+      const ParamDef& a = args[i];
+      if (i == user) continue;
+      if (!first)
       {
-        type = argStr;
-        name = "arg" + std::to_string(argCount++);
+        sig << ", ";
+        tuple << ", ";
       }
-      boost::trim(type);
-      boost::trim(name);
-      if (name == "const" || name == "unsigned" || name == "struct" || name == "enum")
+      first = false;
+      sig << a.name << ": " << cpp_to_ts_type(a.type);
+      tuple << cpp_to_ts_type(a.type);
+    }
+    if (cb.queued) return "((events: Array<[" + tuple.str() + "]>) => void) | null";
+    return "((" + sig.str() + ") => " + cpp_to_ts_type(cb.retType) + ") | null";
+  }
+
+  // [New] Exactly `double f(double[, double]) noexcept`: registered as JS_CFUNC_f_f / f_f_f.
+  bool is_typed_f64(const FuncDef& f)
+  {
+    if (!f.isNoexcept || strip_cv_ref(f.retType) != "double" || f.retType.find('&') != std::string::npos) return false;
+    std::vector<ParamDef> params = parse_params(f.args);
+    if (params.empty() || params.size() > 2) return false;
+    return std::all_of(params.begin(), params.end(), [&](const ParamDef& p)
+    {
+      return !p.isArray && strip_cv_ref(p.type) == "double" && p.type.find('&') == std::string::npos;
+    });
+  }
+
+  // [New] Whether `<name>_batch` (Wrapper<name>::call_batch) is emitted: every parameter and
+  // the result must map onto a TypedArray element type.
+  bool is_batchable(const FuncDef& f)
+  {
+    auto elem_ok = [&](const std::string& type)
+    {
+      std::string t = strip_cv_ref(type);
+      return type.find('*') == std::string::npos && t != "char" && t != "void" && !ts_typed_array(t).empty();
+    };
+    std::vector<ParamDef> params = parse_params(f.args);
+    if (params.empty() || !(strip_cv_ref(f.retType) == "void" || elem_ok(f.retType))) return false;
+    for (const auto& p : params)
+      if (p.isArray || !elem_ok(p.type)) return false;
+    for (const auto& other : functions)
+      if (other.name == f.name + "_batch") return false;
+    return !is_overloaded(f);
+  }
+
+  // Position of `name` in this translation unit's atom table.
+  size_t atom_index(const std::string& name)
+  {
+    auto it = atomIndex.find(name);
+    if (it == atomIndex.end())
+    {
+      it = atomIndex.emplace(name, atomNames.size()).first;
+      atomNames.push_back(name);
+    }
+    return it->second;
+  }
+
+  // C++ expression for the interned atom of `name`, valid where `atoms` is in scope.
+  std::string atom_ref(const std::string& name)
+  {
+    return "atoms[" + std::to_string(atom_index(name)) + "] /* " + name + " */";
+  }
+
+  // Allows basic types and known structs/enums.
+  // `S*` / `const S*` for a struct bound by this module.
+  bool is_struct_pointer(std::string type)
+  {
+    if (type.find('*') == std::string::npos) return false;
+    boost::replace_all(type, "const", "");
+    boost::replace_all(type, "*", "");
+    boost::trim(type);
+    return std::any_of(structs.begin(), structs.end(), [&](const StructDef& s) { return s.name == type; });
+  }
+
+  // QJS_BORROWED (or --borrowed=<name>) on a function returning a struct pointer.
+  bool is_borrowed_return(const FuncDef& f)
+  {
+    return borrowedReturns.count(f.name) && is_struct_pointer(f.retType);
+  }
+
+  // Signature of a callable parameter type: a callback typedef, `R (*)(...)` or
+  // std::function<R(...)>. False for anything else.
+  bool callback_signature(const std::string& type, bool& cPointer, std::string& ret, std::string& args)
+  {
+    static const boost::regex re_fnptr(R"((.*?)\(\s*\*\s*\)\s*\((.*)\))");
+    static const boost::regex re_function(R"((?:const\s+)?std::function\s*<\s*(.*?)\s*\((.*)\)\s*>\s*&?)");
+    std::string t = boost::trim_copy(type);
+    boost::smatch m;
+    if (boost::regex_match(t, m, re_function))
+    {
+      cPointer = false;
+      ret = m[1].str();
+      args = m[2].str();
+      return true;
+    }
+    cPointer = true;
+    if (boost::regex_match(t, m, re_fnptr))
+    {
+      ret = boost::trim_copy(m[1].str());
+      args = m[2].str();
+      return true;
+    }
+    std::string name = strip_cv_ref(t);
+    for (const auto& cb : callbacks)
+    {
+      if (cb.name != name) continue;
+      ret = cb.retType;
+      args = cb.args;
+      return true;
+    }
+    return false;
+  }
+
+  bool is_void_pointer(const std::string& type) { return boost::erase_all_copy(type, " ") == "void*"; }
+
+  // [New] Callback parameters of a signature, by index. A C function pointer is bound only
+  // with a `void*` user-data parameter right next to it and a `void*` in its own signature
+  // (the trampoline finds its JS function through it); `ok` is false otherwise.
+  std::map<size_t, CallbackParam> callback_params(const std::vector<ParamDef>& params, bool queued, bool* ok = nullptr)
+  {
+    std::map<size_t, CallbackParam> cbs;
+    std::set<size_t> taken;
+    if (ok) *ok = true;
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+      CallbackParam cb;
+      if (!callback_signature(params[i].type, cb.cPointer, cb.retType, cb.args)) continue;
+      cb.queued = queued && strip_cv_ref(cb.retType) == "void";
+      if (cb.cPointer)
       {
-        type = argStr;
-        name = "arg" + std::to_string(argCount++);
+        std::vector<ParamDef> sig = parse_params(cb.args);
+        bool hasUser = std::any_of(sig.begin(), sig.end(), [&](const ParamDef& a) { return is_void_pointer(a.type); });
+        if (i + 1 < params.size() && is_void_pointer(params[i + 1].type) && !taken.count(i + 1)) cb.userIndex = i + 1;
+        else if (i > 0 && is_void_pointer(params[i - 1].type) && !taken.count(i - 1)) cb.userIndex = i - 1;
+        else hasUser = false;
+        if (!hasUser)
+        {
+          if (ok) *ok = false;
+          continue;
+        }
+        taken.insert(cb.userIndex);
       }
-      boost::replace_all(name, "const", "");
-      boost::trim(name);
-      std::string tsType = cpp_to_ts_type(type);
-      if (isArray) tsType += "[]";
-      if (i > 0) ss << ", ";
-      ss << name << ": " << tsType;
+      cbs[i] = cb;
     }
-    return ss.str();
+    return cbs;
   }
 
-  std::vector<std::string> get_active_guards(const std::vector<GuardState>& stack)
+  std::map<size_t, CallbackParam> callback_params(const FuncDef& f, bool* ok = nullptr)
   {
-    std::vector<std::string> active;
-    for (const auto& g : stack) if (!g.isHeaderGuard) active.push_back(g.line);
-    return active;
+    return callback_params(parse_params(f.args), queuedFunctions.count(f.name) > 0, ok);
   }
 
-  std::string invert_guard(const std::string& line)
+  // Number of JS arguments: buffer pairs count once, C user data is not passed.
+  size_t js_arity(const FuncDef& f)
   {
-    boost::regex re_ifdef(R"(^\s*#ifdef\s+(.*))");
-    boost::smatch m;
-    if (boost::regex_match(line, m, re_ifdef)) return "#ifndef " + m[1].str();
-    boost::regex re_ifndef(R"(^\s*#ifndef\s+(.*))");
-    if (boost::regex_match(line, m, re_ifndef)) return "#ifdef " + m[1].str();
-    boost::regex re_if(R"(^\s*#if\s+(.*))");
-    if (boost::regex_match(line, m, re_if))
+    return js_arity(parse_params(f.args));
+  }
+
+  size_t js_arity(const std::vector<ParamDef>& params)
+  {
+    size_t arity = params.size() - buffer_pairs(params).size();
+    for (const auto& [i, cb] : callback_params(params, false))
+      if (cb.cPointer) arity--;
+    return arity;
+  }
+
+  // [New] QJS_ASYNC (or --async=<name>): `<name>_async` runs the call on the worker pool.
+  // Arguments must be copyable into owned values, so callbacks and buffers are excluded.
+  bool is_async(const FuncDef& f)
+  {
+    if (!asyncFunctions.count(f.name)) return false;
+    std::vector<ParamDef> params = parse_params(f.args);
+    if (!buffer_pairs(params).empty() || !callback_params(params, false).empty()) return false;
+    for (const auto& p : params)
     {
-      std::string cond = m[1].str();
-      boost::trim(cond);
-      return "#if !(" + cond + ")";
+      if (p.isArray || p.type.find("QJSCallback") != std::string::npos || p.type.find("span") != std::string::npos ||
+          p.type.find("QJSBufferView") != std::string::npos || p.type.find("(*") != std::string::npos)
+        return false;
     }
-    return line;
+    for (const auto& other : functions)
+      if (other.name == f.name + "_async") return false;
+    return !is_overloaded(f);
   }
 
-  // [New] Check if a type is safe to use in Accessor (Get/Set)
-  // Allows basic types and known structs/enums.
   bool is_type_safe_for_binding(std::string type)
   {
+    // Containers: every element type must be bindable, map keys must become property names
+    std::vector<std::string> c = std_container(type);
+    if (!c.empty())
+    {
+      if (c[0] == "map" || c[0] == "unordered_map")
+      {
+        std::string key = strip_cv_ref(c[1]);
+        bool enumKey = std::any_of(enums.begin(), enums.end(), [&](const EnumDef& e) { return e.name == key; });
+        if (key.find('*') != std::string::npos || (!is_json_safe(key) && !enumKey)) return false;
+      }
+      for (size_t i = 1; i < c.size(); ++i)
+        if (!is_type_safe_for_binding(c[i])) return false;
+      return true;
+    }
+
     // Normalize
     boost::replace_all(type, "const", "");
     boost::replace_all(type, "volatile", "");
@@ -249,11 +565,209 @@ public:
     return false;
   }
 
+  // [New] Overload dispatch order (QJSOverloadSet): fewer parameters first, then the more
+  // specific parameter kinds, so `set(bool)` is tested before `set(int)`, `set(int)` before
+  // `set(double)` and strings before structs and everything else.
+  int overload_rank(const std::string& type)
+  {
+    std::string t = strip_cv_ref(type);
+    if (t == "bool") return 0;
+    if (t == "char*" || t == "char *" || t == "std::string" || t == "std::string_view") return 3;
+    if (t.find('*') != std::string::npos || !std_container(type).empty()) return 5;
+    if (std::any_of(enums.begin(), enums.end(), [&](const EnumDef& e) { return e.name == t; })) return 1;
+    if (t == "float" || t == "double" || t == "long double") return 2;
+    if (std::any_of(structs.begin(), structs.end(), [&](const StructDef& s) { return s.name == t; })) return 4;
+    static const boost::regex integral(R"((?:(?:un)?signed\s+)?(?:char|short|int|long|long\s+long)(?:\s+int)?|unsigned|u?int(?:8|16|32|64)_t|size_t|ssize_t|ptrdiff_t)");
+    return boost::regex_match(t, integral) ? 1 : 5;
+  }
+
+  bool overload_before(const std::vector<ParamDef>& a, const std::vector<ParamDef>& b)
+  {
+    if (a.size() != b.size()) return a.size() < b.size();
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+      int ra = overload_rank(a[i].type), rb = overload_rank(b[i].type);
+      if (ra != rb) return ra < rb;
+    }
+    return false;
+  }
+
+  // Several declarations share `f`'s name (and preprocessor guards): bound as one dispatcher.
+  bool is_overloaded(const FuncDef& f)
+  {
+    return std::count_if(functions.begin(), functions.end(),
+                         [&](const FuncDef& o) { return o.name == f.name && o.guards == f.guards; }) > 1;
+  }
+
+  // [New] Member functions and constructors: every parameter must convert from a JS value
+  // (no non-const lvalue references, C arrays or C callbacks; std::function is fine) and the
+  // result must convert back.
+  bool is_member_param_bindable(const ParamDef& p)
+  {
+    std::string t = boost::trim_copy(p.type);
+    if (p.isArray || t.empty()) return false;
+    if (t.back() == '&' && t.compare(t.size() - 2, 2, "&&") != 0 && t.find("const") == std::string::npos) return false;
+    bool cPointer = false;
+    std::string ret, args;
+    if (callback_signature(t, cPointer, ret, args)) return !cPointer;
+    return is_type_safe_for_binding(t);
+  }
+
+  bool is_method_bindable(const MethodDef& m)
+  {
+    if (strip_cv_ref(m.retType) != "void" && !is_type_safe_for_binding(m.retType)) return false;
+    std::vector<ParamDef> params = parse_params(m.args);
+    return std::all_of(params.begin(), params.end(), [&](const ParamDef& p) { return is_member_param_bindable(p); });
+  }
+
+  // Parameter lists of the bindable constructors, default arguments expanded into the shorter
+  // forms. Empty for a struct without declared constructors (value-initialised from JS).
+  static bool same_types(const std::vector<ParamDef>& a, const std::vector<ParamDef>& b)
+  {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const ParamDef& x, const ParamDef& y) { return x.type == y.type; });
+  }
+
+  std::vector<std::vector<ParamDef>> ctor_signatures(const StructDef& s)
+  {
+    std::vector<std::vector<ParamDef>> sigs;
+    for (const auto& args : s.ctors)
+    {
+      std::vector<ParamDef> params = parse_params(args);
+      if (!std::all_of(params.begin(), params.end(), [&](const ParamDef& p) { return is_member_param_bindable(p); }))
+        continue;
+      for (size_t n = params.size();; --n)
+      {
+        std::vector<ParamDef> sig(params.begin(), params.begin() + n);
+        if (std::none_of(sigs.begin(), sigs.end(), [&](const auto& other) { return same_types(other, sig); }))
+          sigs.push_back(sig);
+        if (n == 0 || !params[n - 1].hasDefault) break;
+      }
+    }
+    std::stable_sort(sigs.begin(), sigs.end(), [&](const auto& a, const auto& b) { return overload_before(a, b); });
+    return sigs;
+  }
+
+  // Shorter parameter lists of the methods in one overload group, from their trailing default
+  // arguments, longest first. Forms another overload (or an earlier form) already has are left out.
+  std::vector<std::pair<MethodDef, std::vector<ParamDef>>> default_forms(const std::vector<MethodDef>& group)
+  {
+    std::vector<std::vector<ParamDef>> taken;
+    for (const auto& m : group) taken.push_back(parse_params(m.args));
+    std::vector<std::pair<MethodDef, std::vector<ParamDef>>> forms;
+    for (const auto& m : group)
+    {
+      std::vector<ParamDef> params = parse_params(m.args);
+      for (size_t n = params.size(); n > 0 && params[n - 1].hasDefault; --n)
+      {
+        std::vector<ParamDef> sig(params.begin(), params.begin() + n - 1);
+        if (std::any_of(taken.begin(), taken.end(), [&](const auto& other) { return same_types(other, sig); })) continue;
+        taken.push_back(sig);
+        forms.emplace_back(m, sig);
+      }
+    }
+    return forms;
+  }
+
+  // `new S()` works: no declared constructors, or a bindable zero-argument one.
+  bool is_default_constructible(const StructDef& s)
+  {
+    if (s.ctors.empty()) return true;
+    for (const auto& sig : ctor_signatures(s))
+      if (sig.empty()) return true;
+    return false;
+  }
+
+  // The constructor gets a js_<S>_static_funcs list: fromBuffer, static methods or the lazy
+  // `prototype` getter. Without any, the list would be a zero-length array.
+  bool has_static_funcs(const StructDef& s)
+  {
+    return is_default_constructible(s) || !bound_methods(s, true).empty() || lazyInit;
+  }
+
+  // Methods bound on the prototype (or the constructor, for static ones): bindable and not
+  // clashing with a generated member. Overloads stay adjacent, in dispatch order.
+  std::vector<MethodDef> bound_methods(const StructDef& s, bool statics)
+  {
+    static const std::set<std::string> protoReserved = {
+      "toJson", "toObject", "snapshot", "assign", "toBuffer", "constructor"
+    };
+    static const std::set<std::string> staticReserved = {"fromBuffer", "prototype", "name", "length"};
+    std::vector<MethodDef> bound;
+    std::vector<std::string> order;
+    for (const auto& m : s.methods)
+    {
+      if (m.isStatic != statics || !is_method_bindable(m)) continue;
+      if ((statics ? staticReserved : protoReserved).count(m.name)) continue;
+      if (std::find(order.begin(), order.end(), m.name) == order.end()) order.push_back(m.name);
+      bound.push_back(m);
+    }
+    std::stable_sort(bound.begin(), bound.end(), [&](const MethodDef& a, const MethodDef& b)
+    {
+      size_t ia = std::find(order.begin(), order.end(), a.name) - order.begin();
+      size_t ib = std::find(order.begin(), order.end(), b.name) - order.begin();
+      if (ia != ib) return ia < ib;
+      return overload_before(parse_params(a.args), parse_params(b.args));
+    });
+    return bound;
+  }
+
+  // Entry point for one JS name: the candidate itself, or a QJSOverloadSet over all of them.
+  std::string overload_call(const std::vector<std::string>& candidates)
+  {
+    if (candidates.size() == 1) return candidates[0] + "::call";
+    std::string set = "QJSOverloadSet<";
+    for (size_t i = 0; i < candidates.size(); ++i) set += (i ? ", " : "") + candidates[i];
+    return set + ">::call";
+  }
+
+  // Runs of same-named entries in `bound` (see bound_methods).
+  template<typename T>
+  std::vector<std::vector<T>> overload_groups(const std::vector<T>& bound)
+  {
+    std::vector<std::vector<T>> groups;
+    for (const auto& m : bound)
+    {
+      if (groups.empty() || groups.back().front().name != m.name) groups.emplace_back();
+      groups.back().push_back(m);
+    }
+    return groups;
+  }
+
+  // `&S::m`, or a cast to the declared signature when the name is overloaded.
+  std::string member_pointer(const StructDef& s, const MethodDef& m)
+  {
+    size_t count = std::count_if(s.methods.begin(), s.methods.end(), [&](const MethodDef& o) { return o.name == m.name; });
+    std::string ptr = "&" + s.name + "::" + m.name;
+    if (count < 2) return ptr;
+    std::string types;
+    for (const auto& p : parse_params(m.args)) types += (types.empty() ? "" : ", ") + p.type;
+    if (m.isStatic) return "static_cast<" + m.retType + " (*)(" + types + ")>(" + ptr + ")";
+    return "static_cast<" + m.retType + " (" + s.name + "::*)(" + types + ")" + (m.isConst ? " const" : "") + ">(" + ptr +
+      ")";
+  }
+
+  bool is_borrowed_method(const StructDef& s, const MethodDef& m)
+  {
+    return borrowedReturns.count(s.name + "::" + m.name) && is_struct_pointer(m.retType);
+  }
+
   // [New] Strict check for Boost.JSON supported types
   // Boost.JSON supports: bool, int, double, string, nullptr.
   // It does NOT support arbitrary pointers (except char*) or custom structs directly.
   bool is_json_safe(std::string type)
   {
+    // Containers of JSON-safe values (boost::json::value_from); only string-keyed maps,
+    // other keys would serialize as [key, value] pairs instead of an object
+    std::vector<std::string> c = std_container(type);
+    if (!c.empty())
+    {
+      if ((c[0] == "map" || c[0] == "unordered_map") && strip_cv_ref(c[1]) != "std::string") return false;
+      for (size_t i = 1; i < c.size(); ++i)
+        if (!is_json_safe(c[i])) return false;
+      return true;
+    }
+
     // Normalize
     boost::replace_all(type, "const", "");
     boost::replace_all(type, "volatile", "");
@@ -294,338 +808,676 @@ public:
     return false;
   }
 
-  void process_enum(std::string name, std::string body, const std::vector<std::string>& guards)
+  // A leading QJS_OWNED / QJS_BORROWED / QJS_ASYNC / QJS_QUEUED / QJS_RETAINED (qjs_annotations.h) is parsed as part of
+  // the return type; strip it and remember the annotation. QJS_OWNED is the default for pointers.
+  void apply_annotations(HeaderModel& model)
   {
-    boost::regex re_complex_macro(R"(\b[A-Z_][A-Z0-9_]*\s*\()");
-    if (boost::regex_search(body, re_complex_macro)) return;
-    EnumDef edef;
-    edef.name = name;
-    edef.guards = guards;
-    std::map<std::string, int> symbol_table;
-    boost::regex re_member(R"(([a-zA-Z0-9_]+)\s*(?:=\s*([^,]+))?)");
-    boost::smatch m;
-    int currentVal = 0;
-    auto start = body.cbegin();
-    while (boost::regex_search(start, body.cend(), m, re_member))
+    static const boost::regex annotation("\\bQJS_(OWNED|BORROWED|ASYNC|QUEUED|RETAINED)\\b\\s*");
+    for (auto& f : model.functions)
     {
-      std::string key = m[1];
-      std::string val_str = "";
-      if (m.size() > 2 && m[2].matched)
-      {
-        val_str = m[2];
-        size_t cpos = val_str.find("//");
-        if (cpos != std::string::npos) val_str = val_str.substr(0, cpos);
-        cpos = val_str.find("/*");
-        if (cpos != std::string::npos) val_str = val_str.substr(0, cpos);
-        boost::trim(val_str);
-      }
-      if (isdigit(key[0]) || key == "public" || key == "private")
-      {
-        start = m.suffix().first;
-        continue;
-      }
-      int val = currentVal;
-      if (!val_str.empty())
+      if (f.retType.find("QJS_") == std::string::npos) continue;
+      if (f.retType.find("QJS_BORROWED") != std::string::npos) borrowedReturns.insert(f.name);
+      if (f.retType.find("QJS_ASYNC") != std::string::npos) asyncFunctions.insert(f.name);
+      if (f.retType.find("QJS_QUEUED") != std::string::npos) queuedFunctions.insert(f.name);
+      if (f.retType.find("QJS_RETAINED") != std::string::npos) retainedFunctions.insert(f.name);
+      f.retType = boost::regex_replace(f.retType, annotation, "");
+      boost::trim(f.retType);
+    }
+    // Member functions take QJS_OWNED / QJS_BORROWED as `<Struct>::<method>`
+    for (auto& s : model.structs)
+    {
+      for (auto& m : s.methods)
       {
-        val = evaluate_expression(val_str, symbol_table);
-        currentVal = val;
+        if (m.retType.find("QJS_") == std::string::npos) continue;
+        if (m.retType.find("QJS_BORROWED") != std::string::npos) borrowedReturns.insert(s.name + "::" + m.name);
+        m.retType = boost::regex_replace(m.retType, annotation, "");
+        boost::trim(m.retType);
       }
-      symbol_table[key] = val;
-      edef.members.push_back({key, val_str.empty() ? std::to_string(val) : val_str});
-      currentVal++;
-      start = m.suffix().first;
     }
-    if (!edef.members.empty()) enums.push_back(edef);
   }
 
-  void process_struct(std::string name, std::string body, const std::vector<std::string>& guards)
+  void parse()
   {
-    StructDef sdef;
-    sdef.name = name;
-    sdef.guards = guards;
-    boost::regex re_field(R"(([a-zA-Z0-9_:<>\*&\s]+?)\s+(\w+)\s*(?::\s*\d+)?\s*;\s*)");
-    auto start = body.cbegin();
-    boost::smatch m;
-    while (boost::regex_search(start, body.cend(), m, re_field))
+    for (const auto& inputPath : inputPaths)
     {
-      std::string type = clean_type_string(m[1]);
-      std::string fname = m[2];
-      if (isdigit(fname[0]))
+      std::ifstream file(inputPath, std::ios::binary);
+      if (!file.is_open())
       {
-        start = m.suffix().first;
-        continue;
+        std::cerr << "Error: " << inputPath << std::endl;
+        exit(1);
       }
-
-      bool is_func_ptr = (type.find("(") != std::string::npos);
-      bool is_typedef = (type.find("typedef") != std::string::npos);
-      bool is_callback = (type.length() >= 5 && type.substr(type.length() - 5) == "_cb_t") || (type.length() >= 7 &&
-        type.substr(type.length() - 7) == "_walker");
-
-      if (!is_func_ptr && !is_typedef && !is_callback)
+      std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      HeaderModel model = HeaderParser(source).parse();
+      apply_annotations(model);
+      callbacks.insert(callbacks.end(), model.callbacks.begin(), model.callbacks.end());
+      // C callbacks without user data cannot find their JS function
+      auto unbindable = [&](const FuncDef& f)
       {
-        boost::trim(type);
-        sdef.fields.push_back({type, fname});
-      }
-      start = m.suffix().first;
+        bool ok = true;
+        callback_params(f, &ok);
+        if (!ok) std::cerr << "Warning: skipping " << f.name << ": C callback without a void* user-data parameter" << std::endl;
+        return !ok;
+      };
+      model.functions.erase(std::remove_if(model.functions.begin(), model.functions.end(), unbindable),
+                            model.functions.end());
+      functions.insert(functions.end(), model.functions.begin(), model.functions.end());
+      enums.insert(enums.end(), model.enums.begin(), model.enums.end());
+      macros.insert(macros.end(), model.macros.begin(), model.macros.end());
+      structs.insert(structs.end(), model.structs.begin(), model.structs.end());
+      headerModels.push_back(std::move(model));
     }
-    structs.push_back(sdef);
-  }
-
-  void parse()
-  {
-    std::ifstream file(inputPath);
-    if (!file.is_open())
+    for (const auto& f : functions)
     {
-      std::cerr << "Error: " << inputPath << std::endl;
-      exit(1);
+      if (asyncFunctions.count(f.name) && !is_async(f))
+        std::cerr << "Warning: " << f.name << " cannot be bound as async (callback, buffer or name clash)" << std::endl;
+      auto cbs = callback_params(f);
+      if (retainedFunctions.count(f.name) &&
+          std::none_of(cbs.begin(), cbs.end(), [](const auto& cb) { return cb.second.cPointer; }))
+        std::cerr << "Warning: " << f.name << ": no C callback to retain" << std::endl;
+      if (!queuedFunctions.count(f.name)) continue;
+      for (const auto& [i, cb] : cbs)
+        if (!cb.queued)
+          std::cerr << "Warning: " << f.name << ": only void callbacks can be queued, parameter " << i << " stays direct" <<
+            std::endl;
     }
-    std::string line;
-    std::vector<GuardState> guardStack;
-    std::string buffer;
-    int brace_depth = 0;
+  }
 
-    boost::regex re_macro_val(R"(^\s*#define\s+([A-Z0-9_]+)\s+(\".*\"|-?\d+(\.\d+)?))");
-    boost::regex re_define_simple(R"(^\s*#define\s+([A-Z0-9_]+))");
-    boost::regex re_ifndef(R"(^\s*#ifndef\s+([A-Z0-9_]+))");
-    boost::regex re_elif(R"(^\s*#elif\s+(.*))");
-    boost::regex re_enum_cpp(R"(enum\s+(class\s+)?(\w+)\s*\{([\s\S]*?)\};)");
-    boost::regex re_enum_c(R"(typedef\s+enum\s*\{([\s\S]*?)\}\s*(\w+);)");
-    boost::regex re_struct(R"(struct\s+(\w+)\s*\{([\s\S]*?)\};)");
-    boost::regex re_func(R"(([a-zA-Z0-9_:<>\*&\s]+?)\s+(\w+)\s*\(([\s\S]*?)\)\s*(?:;|{))");
-    std::set<std::string> blacklist = {"if", "while", "for", "switch", "return", "sizeof", "operator", "else"};
-    bool in_comment_block = false;
+  // Rough cost of the code emitted for a declaration, used to balance shards.
+  size_t weight_of(const StructDef& s) { return 8 + 4 * s.fields.size() + 2 * (s.methods.size() + s.ctors.size()); }
+  size_t weight_of(const EnumDef& e) { return 1 + e.members.size() / 4; }
+  size_t weight_of(const MacroDef&) { return 1; }
+  size_t weight_of(const FuncDef& f) { return is_batchable(f) ? 3 : 2; }
 
-    while (std::getline(file, line))
+  // Distributes declarations over `shardCount` shards, largest unit first onto the lightest
+  // shard. A unit is a whole header, so an edit to one header only changes its own shard's
+  // output (as long as the edit does not add or remove declarations). With fewer headers than
+  // shards, individual declarations become the units instead. Either way, units that declare
+  // the same function name are merged: overloads from any header share one dispatcher.
+  std::vector<Shard> plan_shards()
+  {
+    struct Unit
     {
-      std::string trimmed = line;
-      boost::trim(trimmed);
-      if (in_comment_block)
-      {
-        if (trimmed.find("*/") != std::string::npos) in_comment_block = false;
-        continue;
-      }
-      if (trimmed.find("/*") != std::string::npos)
-      {
-        if (trimmed.find("*/") == std::string::npos) in_comment_block = true;
-        trimmed = trimmed.substr(0, trimmed.find("/*"));
-      }
-      if (trimmed.find("//") != std::string::npos) trimmed = trimmed.substr(0, trimmed.find("//"));
-      boost::trim(trimmed);
-      if (trimmed.empty()) continue;
-
-      if (trimmed[0] == '#')
+      HeaderModel model;
+      std::vector<std::string> headers;
+      size_t weight = 0;
+    };
+    std::vector<Unit> units;
+    bool perHeader = headerModels.size() >= shardCount;
+    for (size_t h = 0; h < headerModels.size(); ++h)
+    {
+      const HeaderModel& hm = headerModels[h];
+      if (perHeader) units.push_back({HeaderModel(), {inputPaths[h]}, 0});
+      auto add = [&](auto member, const auto& decl)
       {
-        boost::smatch m;
-        if (boost::starts_with(trimmed, "#define"))
-        {
-          if (boost::regex_search(trimmed, m, re_define_simple))
-          {
-            std::string defSym = m[1];
-            if (!guardStack.empty() && guardStack.back().symbol == defSym)
-            {
-              guardStack.back().isHeaderGuard = true;
-              continue;
-            }
-          }
-          if (boost::regex_search(trimmed, m, re_macro_val))
-            macros.push_back({
-              m[1], m[2], get_active_guards(guardStack)
-            });
-        }
-        else if (boost::starts_with(trimmed, "#if"))
-        {
-          GuardState gs;
-          gs.line = trimmed;
-          gs.isHeaderGuard = false;
-          if (boost::starts_with(trimmed, "#ifndef") && boost::regex_search(trimmed, m, re_ifndef)) gs.symbol = m[1];
-          guardStack.push_back(gs);
-        }
-        else if (boost::starts_with(trimmed, "#endif")) { if (!guardStack.empty()) guardStack.pop_back(); }
-        else if (boost::starts_with(trimmed, "#else"))
-        {
-          if (!guardStack.empty())
-          {
-            std::string prev = guardStack.back().line;
-            guardStack.pop_back();
-            guardStack.push_back({invert_guard(prev), "", false});
-          }
-        }
-        else if (boost::starts_with(trimmed, "#elif"))
-        {
-          if (!guardStack.empty())
-          {
-            guardStack.pop_back();
-            if (boost::regex_search(trimmed, m, re_elif)) guardStack.push_back({"#if " + m[1].str(), "", false});
-          }
-        }
-        continue;
-      }
-
-      bool is_extern_c = (line.find("extern \"C\"") != std::string::npos);
-      for (char c : trimmed)
+        if (!perHeader) units.push_back({HeaderModel(), {inputPaths[h]}, 0});
+        (units.back().model.*member).push_back(decl);
+        units.back().weight += weight_of(decl);
+      };
+      for (const auto& d : hm.structs) add(&HeaderModel::structs, d);
+      for (const auto& d : hm.enums) add(&HeaderModel::enums, d);
+      for (const auto& d : hm.functions) add(&HeaderModel::functions, d);
+      for (const auto& d : hm.macros) add(&HeaderModel::macros, d);
+    }
+    // Overloads share one dispatcher: every unit declaring a function name, in any header,
+    // is merged into one (the merged unit includes all of their headers)
+    std::vector<size_t> parent(units.size());
+    for (size_t u = 0; u < units.size(); ++u) parent[u] = u;
+    auto root = [&](size_t u)
+    {
+      while (parent[u] != u) u = parent[u] = parent[parent[u]];
+      return u;
+    };
+    std::map<std::string, size_t> nameUnit;
+    for (size_t u = 0; u < units.size(); ++u)
+      for (const auto& f : units[u].model.functions)
       {
-        if (c == '{') { if (!is_extern_c) brace_depth++; }
-        else if (c == '}') { if (brace_depth > 0) brace_depth--; }
+        auto [it, fresh] = nameUnit.emplace(f.name, u);
+        if (!fresh) parent[root(u)] = root(it->second);
       }
-      buffer += trimmed + "\n";
+    std::vector<Unit> merged;
+    std::map<size_t, size_t> mergedIndex; // root -> index in `merged`
+    auto append = [](auto& dst, const auto& src) { dst.insert(dst.end(), src.begin(), src.end()); };
+    for (size_t u = 0; u < units.size(); ++u)
+    {
+      auto [it, fresh] = mergedIndex.emplace(root(u), merged.size());
+      if (fresh) merged.emplace_back();
+      Unit& dst = merged[it->second];
+      append(dst.model.structs, units[u].model.structs);
+      append(dst.model.enums, units[u].model.enums);
+      append(dst.model.functions, units[u].model.functions);
+      append(dst.model.macros, units[u].model.macros);
+      for (const auto& h : units[u].headers)
+        if (std::find(dst.headers.begin(), dst.headers.end(), h) == dst.headers.end()) dst.headers.push_back(h);
+      dst.weight += units[u].weight;
+    }
+    units = std::move(merged);
+    std::stable_sort(units.begin(), units.end(), [](const Unit& a, const Unit& b) { return a.weight > b.weight; });
 
-      if (brace_depth == 0 && (trimmed.back() == ';' || trimmed.back() == '}'))
-      {
-        boost::smatch m;
-        if (buffer.find("typedef") != std::string::npos && buffer.find("enum") == std::string::npos)
-        {
-          buffer.clear();
-          continue;
-        }
-        if (boost::regex_search(buffer, m, re_struct))
-        {
-          process_struct(m[1], m[2], get_active_guards(guardStack));
-          buffer.clear();
-          continue;
-        }
-        if (boost::regex_search(buffer, m, re_enum_cpp))
-        {
-          process_enum(m[2], m[3], get_active_guards(guardStack));
-          buffer.clear();
-          continue;
-        }
-        if (boost::regex_search(buffer, m, re_enum_c))
-        {
-          process_enum(m[2], m[1], get_active_guards(guardStack));
-          buffer.clear();
-          continue;
-        }
-        if (boost::regex_search(buffer, m, re_func))
-        {
-          std::string rawRet = m[1];
-          std::string name = m[2];
-          std::string rawArgs = m[3];
-          bool skip = false;
-          if (rawRet.find('=') != std::string::npos || rawRet.find("new") != std::string::npos ||
-            rawRet.find("return") != std::string::npos || rawRet.find("delete") != std::string::npos)
-            skip = true;
-          if (rawArgs.find("...") != std::string::npos) skip = true;
-          if (rawArgs.find("(*") != std::string::npos || rawRet.find("(*") != std::string::npos) skip = true;
-          if (rawArgs.find("_cb_t") != std::string::npos || rawRet.find("_cb_t") != std::string::npos) skip = true;
-          if (rawArgs.find("_cb") != std::string::npos || rawRet.find("_cb") != std::string::npos) skip = true;
-          if (rawArgs.find("_walker") != std::string::npos || rawRet.find("_walker") != std::string::npos) skip = true;
-          if (rawArgs.find("_dsc_t") != std::string::npos || rawRet.find("_dsc_t") != std::string::npos) skip = true;
-          if (rawArgs.find("_rb_compare_t") != std::string::npos || rawRet.find("_rb_compare_t") != std::string::npos)
-            skip = true;
-          if (rawArgs.find("_f_t") != std::string::npos || rawRet.find("_f_t") != std::string::npos) skip = true;
-          if (rawArgs.find("_handler_t") != std::string::npos || rawRet.find("_handler_t") != std::string::npos) skip =
-            true;
-          if (rawRet.find("d2_") != std::string::npos || rawArgs.find("d2_") != std::string::npos) skip = true;
-          if (blacklist.count(name)) skip = true;
-          if (!skip)
-          {
-            std::string cleanRet = clean_type_string(rawRet);
-            if (!cleanRet.empty())
-            {
-              functions.push_back({cleanRet, name, clean_args_string(rawArgs), get_active_guards(guardStack)});
-              buffer.clear();
-              continue;
-            }
-          }
-        }
-        buffer.clear();
-      }
+    std::vector<Shard> shards(shardCount);
+    for (auto& u : units)
+    {
+      Shard& target = *std::min_element(shards.begin(), shards.end(),
+                                        [](const Shard& a, const Shard& b) { return a.weight < b.weight; });
+      target.weight += u.weight;
+      append(target.model.structs, u.model.structs);
+      append(target.model.enums, u.model.enums);
+      append(target.model.functions, u.model.functions);
+      append(target.model.macros, u.model.macros);
+      for (const auto& h : u.headers)
+        if (std::find(target.headers.begin(), target.headers.end(), h) == target.headers.end()) target.headers.push_back(h);
     }
+    return shards;
   }
 
-  void generate()
+  // Emits one translation unit binding `sel`. `prefix` names its function list, atom
+  // table and entry points (js_<prefix>_init / js_<prefix>_declare). The `primary` part
+  // also carries the module-wide exports (__bindingStats).
+  void emit_translation_unit(const fs::path& path, const std::vector<std::string>& includes, const HeaderModel& sel,
+                             const std::string& prefix, bool exported, bool primary)
   {
-    fs::path outCppPath = fs::path(outputDir) / (moduleName + "_bind.cpp");
-    fs::path outHPath = fs::path(outputDir) / (moduleName + "_bind.h");
-    fs::path outTSPath = fs::path(outputDir) / (moduleName + ".d.ts");
+    // The body is buffered so the atom table (filled while emitting) can precede it.
+    std::stringstream out;
+    atomNames.clear();
+    atomIndex.clear();
 
-    std::ofstream out(outCppPath.string());
-    out << "// Generated by Project Gemini\n";
-    out << "#include \"quickjs.h\"\n#include \"qjs_utils.hpp\"\n#include <boost/json.hpp>\n";
-    for (const auto& inc : extraIncludes)
+    // 0. Pool opt-outs must be visible before any cpp_to_js instantiation, in every
+    //    translation unit (a shard may return a struct bound in another shard)
+    for (const auto& s : structs)
     {
-      if (inc.empty()) continue;
-      if (inc.find('<') == std::string::npos && inc.find('"') == std::string::npos)
-        out << "#include \"" << inc <<
-          "\"\n";
-      else out << "#include " << inc << "\n";
+      if (!noPoolStructs.count(s.name)) continue;
+      for (const auto& g : s.guards) out << g << "\n";
+      out << "struct " << s.name << ";\n";
+      out << "template<> struct QJSUsePool<" << s.name << "> : std::false_type {};\n";
+      for (size_t i = 0; i < s.guards.size(); ++i) out << "#endif\n";
     }
 
     // 1. Structs
-    for (const auto& s : structs)
+    for (const auto& s : sel.structs)
     {
       for (const auto& g : s.guards) out << g << "\n";
       std::string classId = "js_" + s.name + "_class_id";
-      out << "static JSClassID " << classId << ";\n";
-      out << "template<> JSClassID JSClassIdTraits<" << s.name << ">::id = 0;\n";
+      // Filled once per process by qjs_class_id<S>; the module init only reads it
+      out << "static const JSClassID& " << classId << " = JSClassIdTraits<" << s.name << ">::id;\n";
       out << "static void js_" << s.name << "_finalizer(JSRuntime *rt, JSValue val) {\n";
-      out << "    " << s.name << "* ptr = (" << s.name << "*)JS_GetOpaque(val, " << classId << ");\n";
-      out << "    if (ptr) delete ptr;\n";
+      out << "    qjs_release_opaque<" << s.name << ">(rt, JS_GetOpaque(val, " << classId << "));\n";
       out << "}\n";
+      out << "static void js_" << s.name << "_gc_mark(JSRuntime *rt, JSValueConst val, JS_MarkFunc *mark_func) {\n";
+      out << "    qjs_mark_opaque<" << s.name << ">(rt, JS_GetOpaque(val, " << classId << "), mark_func);\n";
+      out << "}\n";
+      if (lazyInit) out << "static int js_" << s.name << "_materialize(JSContext* ctx);\n";
       out << "static JSValue js_" << s.name <<
         "_ctor(JSContext *ctx, JSValueConst new_target, int argc, JSValueConst *argv) {\n";
-      out << "    " << s.name << "* obj = new " << s.name << "();\n";
-      out << "    JSValue val = JS_NewObjectClass(ctx, " << classId << ");\n";
-      out << "    JS_SetOpaque(val, obj);\n";
-      out << "    return val;\n";
+      std::vector<std::vector<ParamDef>> ctors = ctor_signatures(s);
+      if (!s.ctors.empty() && ctors.empty())
+      {
+        out << "    return JS_ThrowTypeError(ctx, \"" << s.name << ": no constructor is callable from JS\");\n";
+      }
+      else if (!s.ctors.empty())
+      {
+        // Declared constructors: construct first, so a failed overload match leaves no object behind
+        if (lazyInit) out << "    if (js_" << s.name << "_materialize(ctx) < 0) return JS_EXCEPTION;\n";
+        out << "    " << s.name << "* obj = qjs_construct<" << s.name;
+        for (const auto& sig : ctors)
+        {
+          out << ", QJSCtor<";
+          for (size_t i = 0; i < sig.size(); ++i) out << (i ? ", " : "") << sig[i].type;
+          out << ">";
+        }
+        out << ">(ctx, argc, argv);\n";
+        out << "    if (!obj) return JS_EXCEPTION;\n";
+        out << "    JSValue val = JS_NewObjectClass(ctx, " << classId << ");\n";
+        out << "    if (JS_IsException(val)) {\n";
+        out << "        qjs_destroy<" << s.name << ">(JS_GetRuntime(ctx), obj);\n";
+        out << "        return val;\n";
+        out << "    }\n";
+        out << "    JS_SetOpaque(val, obj);\n";
+        out << "    return val;\n";
+      }
+      else
+      {
+        if (lazyInit) out << "    if (js_" << s.name << "_materialize(ctx) < 0) return JS_EXCEPTION;\n";
+        out << "    JSValue val = JS_NewObjectClass(ctx, " << classId << ");\n";
+        out << "    if (JS_IsException(val)) return val;\n";
+        out << "    JS_SetOpaque(val, qjs_create<" << s.name << ">(JS_GetRuntime(ctx)));\n";
+        out << "    return val;\n";
+      }
       out << "}\n";
 
-      std::vector<std::string> valid_fields;
+      // Fields go through the struct's descriptor table (one QJSFieldAccess get/set pair,
+      // the magic is the table index); bit-fields have no member pointer and get their own
+      // conversion functions in the table.
+      std::vector<FieldDef> bound_fields;
       for (const auto& f : s.fields)
       {
         // [FIX] Ensure safe for accessors (known struct or basic)
         if (!is_type_safe_for_binding(f.type)) continue;
 
-        valid_fields.push_back(f.name);
-        out << "static JSValue js_" << s.name << "_get_" << f.name << "(JSContext *ctx, JSValueConst this_val) {\n";
-        out << "    " << s.name << "* obj = (" << s.name << "*)JS_GetOpaque(this_val, " << classId << ");\n";
-        out << "    if (!obj) return JS_EXCEPTION;\n";
-        out << "    return cpp_to_js(ctx, obj->" << f.name << ");\n";
+        bound_fields.push_back(f);
+        if (!f.bitfield) continue;
+        out << "static JSValue js_" << s.name << "_get_" << f.name <<
+          "(JSContext *ctx, JSValueConst this_val, const void* obj) {\n";
+        out << "    return cpp_to_js(ctx, static_cast<const " << s.name << "*>(obj)->" << f.name << ");\n";
         out << "}\n";
-        out << "static JSValue js_" << s.name << "_set_" << f.name <<
-          "(JSContext *ctx, JSValueConst this_val, JSValueConst val) {\n";
-        out << "    " << s.name << "* obj = (" << s.name << "*)JS_GetOpaque(this_val, " << classId << ");\n";
-        out << "    if (!obj) return JS_EXCEPTION;\n";
-        out << "    obj->" << f.name << " = js_to_cpp<" << f.type << ">(ctx, val);\n";
-        out << "    return JS_UNDEFINED;\n";
+        out << "static void js_" << s.name << "_set_" << f.name << "(JSContext *ctx, void* obj, JSValueConst val) {\n";
+        out << "    static_cast<" << s.name << "*>(obj)->" << f.name << " = js_to_cpp<" << f.type << ">(ctx, val);\n";
+        out << "}\n";
+      }
+      std::string fieldAccess = "js_" + s.name + "_field_access";
+      if (!bound_fields.empty())
+      {
+        out << "static constexpr QJSFieldDesc js_" << s.name << "_fields[] = {\n";
+        for (const auto& f : bound_fields)
+        {
+          if (f.bitfield)
+            out << "    qjs_field<" << f.type << ">(\"" << f.name << "\", " << atom_index(f.name) << ", js_" << s.name <<
+              "_get_" << f.name << ", js_" << s.name << "_set_" << f.name << "),\n";
+          else
+            out << "    qjs_field<&" << s.name << "::" << f.name << ">(\"" << f.name << "\", " << atom_index(f.name) <<
+              "),\n";
+        }
+        out << "};\n";
+        out << "using " << fieldAccess << " = QJSFieldAccess<" << s.name << ", js_" << s.name << "_fields>;\n";
+        // JSClassIdTraits<S>::assign: plain objects written to an S member of another struct
+        out << "static JSValue js_" << s.name << "_assign_into(JSContext *ctx, void* obj, JSValueConst values) {\n";
+        out << "    const JSAtom* atoms = js_" << prefix << "_atoms(ctx);\n";
+        out << "    if (!atoms) return JS_EXCEPTION;\n";
+        out << "    return " << fieldAccess << "::assign_into(ctx, static_cast<" << s.name << "*>(obj), values, atoms);\n";
         out << "}\n";
       }
 
       // [FIX] Strict White-list for JSON serialization
       out << "static JSValue js_" << s.name <<
         "_toJson(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {\n";
-      out << "    " << s.name << "* obj = (" << s.name << "*)JS_GetOpaque(this_val, " << classId << ");\n";
+      out << "    " << s.name << "* obj = qjs_unwrap<" << s.name << ">(this_val);\n";
       out << "    if (!obj) return JS_EXCEPTION;\n";
       out << "    boost::json::object j;\n";
       for (const auto& f : s.fields)
       {
         if (!is_json_safe(f.type)) continue;
-        out << "    j[\"" << f.name << "\"] = obj->" << f.name << ";\n";
+        if (!std_container(f.type).empty())
+          out << "    j[\"" << f.name << "\"] = boost::json::value_from(obj->" << f.name << ");\n";
+        else out << "    j[\"" << f.name << "\"] = obj->" << f.name << ";\n";
       }
       out << "    std::string s = boost::json::serialize(j);\n";
       out << "    return JS_NewString(ctx, s.c_str());\n";
       out << "}\n";
 
-      out << "static const JSCFunctionListEntry js_" << s.name << "_proto_funcs[] = {\n";
-      for (const auto& name : valid_fields)
+      // [New] toObject / snapshot / toBuffer / fromBuffer: no JSON round trip. toObject returns
+      //       nested structs as views, like the getters; snapshot copies them
+      for (bool copy : {false, true})
+      {
+        out << "static JSValue js_" << s.name << (copy ? "_snapshot" : "_toObject") <<
+          "(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {\n";
+        if (!bound_fields.empty())
+        {
+          out << "    const JSAtom* atoms = js_" << prefix << "_atoms(ctx);\n";
+          out << "    if (!atoms) return JS_EXCEPTION;\n";
+          out << "    return " << fieldAccess << "::to_object(ctx, this_val, atoms" << (copy ? ", true" : "") << ");\n";
+        }
+        else
+        {
+          out << "    if (!qjs_unwrap<" << s.name << ">(this_val)) return JS_EXCEPTION;\n";
+          out << "    return JS_NewObject(ctx);\n";
+        }
+        out << "}\n";
+      }
+      // [New] assign(values): bulk write of every bound field present on `values`, one loop
+      //       over the same descriptors as the setters
+      out << "static JSValue js_" << s.name <<
+        "_assign(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {\n";
+      if (!bound_fields.empty())
+      {
+        out << "    const JSAtom* atoms = js_" << prefix << "_atoms(ctx);\n";
+        out << "    if (!atoms) return JS_EXCEPTION;\n";
+        out << "    return " << fieldAccess << "::assign(ctx, this_val, argc > 0 ? argv[0] : JS_UNDEFINED, atoms);\n";
+      }
+      else
+      {
+        out << "    if (!qjs_unwrap<" << s.name << ">(this_val)) return JS_EXCEPTION;\n";
+        out << "    if (argc < 1 || !JS_IsObject(argv[0])) return JS_ThrowTypeError(ctx, \"" << s.name <<
+          ".assign: expected an object\");\n";
+        out << "    return JS_DupValue(ctx, this_val);\n";
+      }
+      out << "}\n";
+      // Byte-for-byte copy only when the struct is exactly its bound fields (never with bit-fields)
+      std::string rawLayout = "js_" + s.name + "_raw_layout";
+      bool hasBitfield = std::any_of(bound_fields.begin(), bound_fields.end(), [](const FieldDef& f) { return f.bitfield; });
+      out << "static constexpr bool " << rawLayout << " = ";
+      if (hasBitfield || bound_fields.empty()) out << "false;\n";
+      else
+      {
+        out << "qjs_raw_layout_v<" << s.name;
+        for (const auto& f : bound_fields) out << ", decltype(" << s.name << "::" << f.name << ")";
+        out << ">;\n";
+      }
+      out << "static JSValue js_" << s.name <<
+        "_toBuffer(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {\n";
+      out << "    " << s.name << "* obj = qjs_unwrap<" << s.name << ">(this_val);\n";
+      out << "    if (!obj) return JS_EXCEPTION;\n";
+      out << "    return qjs_struct_to_buffer<" << rawLayout << ">(ctx, *obj, [&](auto& w) {\n";
+      for (const auto& f : bound_fields) out << "        w.put(obj->" << f.name << ");\n";
+      out << "    });\n";
+      out << "}\n";
+      // fromBuffer fills a value-initialised temporary
+      bool fromBuffer = is_default_constructible(s);
+      if (fromBuffer)
+      {
+        out << "static JSValue js_" << s.name <<
+          "_fromBuffer(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {\n";
+        out << "    if (argc < 1) return JS_ThrowTypeError(ctx, \"Arg count mismatch\");\n";
+        out << "    " << s.name << " tmp{};\n";
+        out << "    QJSBufferView<const uint8_t> buf = qjs_buffer_view<const uint8_t>(ctx, argv[0]);\n";
+        out << "    if (!buf.data() && JS_HasException(ctx)) return JS_EXCEPTION; // detached\n";
+        out << "    if (!qjs_struct_from_buffer<" << rawLayout << ">(buf, tmp, [&](auto& r) {\n";
+        for (const auto& f : bound_fields)
+        {
+          // A bit-field cannot bind to T&: read into a copy
+          if (f.bitfield)
+            out << "        { auto v = tmp." << f.name << "; r.get(v); tmp." << f.name << " = v; }\n";
+          else out << "        r.get(tmp." << f.name << ");\n";
+        }
+        out << "    }))\n";
+        out << "        return JS_ThrowRangeError(ctx, \"" << s.name << ".fromBuffer: malformed buffer\");\n";
+        out << "    return cpp_to_js(ctx, std::move(tmp));\n";
+        out << "}\n";
+      }
+      // [New] Static methods returning a QJS_BORROWED pointer go through a qjs_borrow adapter
+      std::vector<MethodDef> statics = bound_methods(s, true);
+      std::vector<std::string> staticTargets;
+      for (size_t i = 0; i < statics.size(); ++i)
+      {
+        const MethodDef& m = statics[i];
+        if (!is_borrowed_method(s, m))
+        {
+          staticTargets.push_back(member_pointer(s, m));
+          continue;
+        }
+        bool overloaded = member_pointer(s, m)[0] != '&';
+        staticTargets.push_back("qjs_borrow_" + s.name + "_" + m.name + (overloaded ? "_" + std::to_string(i) : ""));
+        std::vector<ParamDef> params = parse_params(m.args);
+        std::stringstream decl, call;
+        for (size_t i = 0; i < params.size(); ++i)
+        {
+          decl << (i ? ", " : "") << params[i].type << " a" << i;
+          call << (i ? ", " : "") << "a" << i;
+        }
+        out << "static auto " << staticTargets.back() << "(" << decl.str() << ") {\n";
+        out << "    return qjs_borrow(" << s.name << "::" << m.name << "(" << call.str() << "));\n";
+        out << "}\n";
+      }
+
+      // [New] Trailing default arguments: each shorter form of a method or static is one more
+      //       overload candidate, an adapter in qjs_default_args_<S> that calls it with the
+      //       leading arguments only (constructors get the same expansion in ctor_signatures)
+      std::string holder = "qjs_default_args_" + s.name;
+      std::vector<std::pair<MethodDef, std::vector<ParamDef>>> defaults;
+      for (bool isStatic : {false, true})
+        for (const auto& group : overload_groups(bound_methods(s, isStatic)))
+          for (auto& form : default_forms(group)) defaults.push_back(std::move(form));
+      auto adapter_ret = [&](const MethodDef& m)
+      {
+        if (m.isStatic && is_borrowed_method(s, m)) return "decltype(qjs_borrow(std::declval<" + m.retType + ">()))";
+        return m.retType;
+      };
+      auto adapter_pointer = [&](const MethodDef& m, const std::vector<ParamDef>& params)
+      {
+        std::string ptr = "&" + holder + "::" + m.name;
+        size_t count = std::count_if(defaults.begin(), defaults.end(), [&](const auto& d) { return d.first.name == m.name; });
+        if (count < 2) return ptr;
+        std::string types = m.isStatic ? "" : s.name + "&";
+        for (const auto& p : params) types += (types.empty() ? "" : ", ") + p.type;
+        return "static_cast<" + adapter_ret(m) + " (*)(" + types + ")>(" + ptr + ")";
+      };
+      if (!defaults.empty())
       {
-        out << "    JS_CGETSET_DEF(\"" << name << "\", js_" << s.name << "_get_" << name << ", js_" << s.name << "_set_"
-          << name << "),\n";
+        out << "struct " << holder << " {\n";
+        for (const auto& [m, params] : defaults)
+        {
+          std::stringstream decl, call;
+          if (!m.isStatic) decl << s.name << "& self";
+          for (size_t i = 0; i < params.size(); ++i)
+          {
+            decl << (i || !m.isStatic ? ", " : "") << params[i].type << " a" << i;
+            call << (i ? ", " : "") << "std::forward<" << params[i].type << ">(a" << i << ")";
+          }
+          std::string target = (m.isStatic ? s.name + "::" : std::string("self.")) + m.name + "(" + call.str() + ")";
+          if (m.isStatic && is_borrowed_method(s, m)) target = "qjs_borrow(" + target + ")";
+          out << "    static " << adapter_ret(m) << " " << m.name << "(" << decl.str() << ") { return " << target <<
+            "; }\n";
+        }
+        out << "};\n";
       }
+      // One JS function per name: full and shorter forms in dispatch order, length = fewest JS arguments
+      auto register_group = [&](const std::string& name, std::vector<std::pair<std::vector<ParamDef>, std::string>> calls)
+      {
+        std::stable_sort(calls.begin(), calls.end(), [&](const auto& a, const auto& b) { return overload_before(a.first, b.first); });
+        std::vector<std::string> candidates;
+        size_t arity = js_arity(calls[0].first);
+        for (const auto& [params, candidate] : calls)
+        {
+          candidates.push_back(candidate);
+          arity = std::min(arity, js_arity(params));
+        }
+        out << "    JS_CFUNC_DEF(\"" << name << "\", " << arity << ", (" << overload_call(candidates) << ")),\n";
+      };
+
+      out << "static const JSCFunctionListEntry js_" << s.name << "_proto_funcs[] = {\n";
+      for (size_t i = 0; i < bound_fields.size(); ++i)
+        out << "    JS_CGETSET_MAGIC_DEF(\"" << bound_fields[i].name << "\", " << fieldAccess << "::get, " << fieldAccess <<
+          "::set, " << i << "),\n";
       out << "    JS_CFUNC_DEF(\"toJson\", 0, js_" << s.name << "_toJson),\n";
+      out << "    JS_CFUNC_DEF(\"toObject\", 0, js_" << s.name << "_toObject),\n";
+      out << "    JS_CFUNC_DEF(\"snapshot\", 0, js_" << s.name << "_snapshot),\n";
+      out << "    JS_CFUNC_DEF(\"assign\", 1, js_" << s.name << "_assign),\n";
+      out << "    JS_CFUNC_DEF(\"toBuffer\", 0, js_" << s.name << "_toBuffer),\n";
+      // [New] Member functions: QJSMethod calls through the member pointer on the unwrapped `this`;
+      //       overloads share a QJSOverloadSet dispatcher
+      for (const auto& group : overload_groups(bound_methods(s, false)))
+      {
+        std::vector<std::pair<std::vector<ParamDef>, std::string>> calls;
+        for (const auto& m : group)
+          calls.emplace_back(parse_params(m.args), "QJSMethod<" + member_pointer(s, m) + (is_borrowed_method(s, m) ? ", true" : "") + ">");
+        for (const auto& [m, params] : defaults)
+          if (!m.isStatic && m.name == group[0].name)
+            calls.emplace_back(params, "QJSMethod<" + adapter_pointer(m, params) + (is_borrowed_method(s, m) ? ", true" : "") + ">");
+        register_group(group[0].name, calls);
+      }
       out << "};\n";
+      if (lazyInit)
+      {
+        // Registers the class with the runtime and builds the prototype for this context the
+        // first time an instance is created or the constructor's `prototype` is read.
+        out << "static int js_" << s.name << "_materialize(JSContext* ctx) {\n";
+        out << "    if (qjs_class_registered(JS_GetRuntime(ctx), " << classId << ") && qjs_has_class_proto(ctx, " <<
+          classId << ")) return 0;\n";
+        out << "    JSClassDef def = { \"" << s.name << "\", .finalizer = js_" << s.name << "_finalizer, .gc_mark = js_" << s.name <<
+          "_gc_mark };\n";
+        out << "    if (qjs_register_class(ctx, " << classId << ", &def) < 0) return -1;\n";
+        out << "    JSValue proto = JS_NewObject(ctx);\n";
+        out << "    if (JS_IsException(proto)) return -1;\n";
+        out << "    JS_SetPropertyFunctionList(ctx, proto, js_" << s.name << "_proto_funcs, sizeof(js_" << s.name <<
+          "_proto_funcs)/sizeof(JSCFunctionListEntry));\n";
+        out << "    JS_SetClassProto(ctx, " << classId << ", proto);\n";
+        out << "    return 0;\n";
+        out << "}\n";
+        // Replaces itself with the real data property on first read.
+        out << "static JSValue js_" << s.name << "_lazy_prototype(JSContext *ctx, JSValueConst this_val) {\n";
+        out << "    if (js_" << s.name << "_materialize(ctx) < 0) return JS_EXCEPTION;\n";
+        out << "    JSValue proto = JS_GetClassProto(ctx, " << classId << ");\n";
+        out << "    JS_SetConstructor(ctx, this_val, proto);\n";
+        out << "    return proto;\n";
+        out << "}\n";
+      }
+      if (has_static_funcs(s)) out << "static const JSCFunctionListEntry js_" << s.name << "_static_funcs[] = {\n";
+      if (fromBuffer) out << "    JS_CFUNC_DEF(\"fromBuffer\", 1, js_" << s.name << "_fromBuffer),\n";
+      for (size_t i = 0; i < statics.size();)
+      {
+        std::vector<std::pair<std::vector<ParamDef>, std::string>> calls;
+        size_t first = i;
+        for (; i < statics.size() && statics[i].name == statics[first].name; ++i)
+          calls.emplace_back(parse_params(statics[i].args), "Wrapper<" + staticTargets[i] + ">");
+        for (const auto& [m, params] : defaults)
+          if (m.isStatic && m.name == statics[first].name) calls.emplace_back(params, "Wrapper<" + adapter_pointer(m, params) + ">");
+        register_group(statics[first].name, calls);
+      }
+      if (lazyInit) out << "    JS_CGETSET_DEF(\"prototype\", js_" << s.name << "_lazy_prototype, NULL),\n";
+      if (has_static_funcs(s)) out << "};\n";
       for (size_t i = 0; i < s.guards.size(); ++i) out << "#endif\n";
       out << "\n";
     }
 
-    out << "\nstatic const JSCFunctionListEntry js_" << moduleName << "_funcs[] = {\n";
-    for (const auto& f : functions)
+    // 2. Adapters: `T* data, size_t len` pairs collapse into one QJSBufferView argument,
+    //    QJS_BORROWED results are wrapped in QJSBorrowed so their finalizer never deletes them,
+    //    and JS functions become C trampolines (QJSCallbackArg) or queued std::functions
+    std::map<size_t, std::string> adapted; // index in sel.functions -> adapter
+    for (size_t fi = 0; fi < sel.functions.size(); ++fi)
     {
+      const FuncDef& f = sel.functions[fi];
+      std::vector<ParamDef> params = parse_params(f.args);
+      std::set<size_t> pairs = buffer_pairs(params);
+      bool borrowed = is_borrowed_return(f);
+      std::map<size_t, CallbackParam> cbs = callback_params(f);
+      std::map<size_t, size_t> userOf; // user-data index -> callback index
+      bool cCallbacks = false, queuedStd = false;
+      for (const auto& [i, cb] : cbs)
+      {
+        if (cb.cPointer) userOf[cb.userIndex] = i;
+        cCallbacks |= cb.cPointer;
+        queuedStd |= !cb.cPointer && cb.queued;
+      }
+      if (pairs.empty() && !borrowed && !cCallbacks && !queuedStd) continue;
+      std::string adapter = (cCallbacks || queuedStd ? "qjs_cb_" : pairs.empty() ? "qjs_borrow_" : "qjs_buf_") +
+        f.name + (is_overloaded(f) ? "_" + std::to_string(fi) : "");
+      adapted[fi] = adapter;
+      std::stringstream decl, call, slots;
+      for (size_t i = 0; i < params.size(); ++i)
+      {
+        if (i > 0) call << ", ";
+        std::string pname = "a" + std::to_string(i);
+        if (userOf.count(i))
+        {
+          // Direct callbacks die with the argument when the call returns; retained and queued
+          // ones are kept in a per-runtime slot named by a static of this adapter
+          const CallbackParam& cb = cbs[userOf[i]];
+          if (cb.queued || retainedFunctions.count(f.name))
+          {
+            std::string slot = "a" + std::to_string(userOf[i]) + "_slot";
+            slots << "    static constexpr char " << slot << "[] = \"" << f.name << "#" << userOf[i] << "\";\n";
+            call << "a" << userOf[i] << ".user_data(" << slot << ")";
+          }
+          else call << "a" << userOf[i] << ".user_data()";
+          continue;
+        }
+        if (!decl.str().empty()) decl << ", ";
+        if (pairs.count(i))
+        {
+          decl << "QJSBufferView<" << buffer_elem_type(params[i].type) << "> " << pname;
+          call << pname << ".data(), static_cast<" << params[i + 1].type << ">(" << pname << ".size())";
+          ++i;
+        }
+        else if (cbs.count(i) && cbs[i].cPointer)
+        {
+          decl << "QJSCallbackArg<" << params[i].type << ", " << (cbs[i].queued ? "true" : "false") << "> " << pname;
+          call << pname << ".function()";
+        }
+        else if (cbs.count(i) && cbs[i].queued)
+        {
+          decl << "QJSQueuedFunction<void(" << cbs[i].args << ")> " << pname;
+          call << pname;
+        }
+        else
+        {
+          decl << params[i].type << " " << pname;
+          call << pname;
+        }
+      }
+      std::string result = f.name + "(" + call.str() + ")";
+      if (borrowed) result = "qjs_borrow(" + result + ")";
       for (const auto& g : f.guards) out << g << "\n";
-      out << "    JS_CFUNC_DEF(\"" << f.name << "\", 0, (Wrapper<" << f.name << ">::call)),\n";
+      out << "static " << (borrowed ? "auto" : f.retType) << " " << adapter << "(" << decl.str() << ") {\n";
+      out << slots.str();
+      if (!cCallbacks) out << "    return " << result << ";\n";
+      else if (strip_cv_ref(f.retType) == "void")
+      {
+        out << "    QJSCallbackScope scope; // surfaces what a callback threw once the call returns\n";
+        out << "    " << result << ";\n";
+        out << "    scope.check();\n";
+      }
+      else
+      {
+        out << "    QJSCallbackScope scope; // surfaces what a callback threw once the call returns\n";
+        out << "    return scope.check(" << result << ");\n";
+      }
+      out << "}\n";
       for (size_t i = 0; i < f.guards.size(); ++i) out << "#endif\n";
     }
-    for (const auto& m : macros)
+
+    // A zero-length array is ill-formed: a part without functions or macros has no export
+    // list, except for the primary part's __bindingStats in profiling builds.
+    bool funcList = !sel.functions.empty() || !sel.macros.empty();
+    std::string listGuard = funcList || !primary ? "" : "#ifdef QJS_PROFILE_BINDING\n";
+    std::string listEnd = listGuard.empty() ? "" : "#endif\n";
+    if (funcList || primary) out << "\n" << listGuard << "static const JSCFunctionListEntry js_" << prefix << "_funcs[] = {\n";
+    for (size_t fi = 0; fi < sel.functions.size(); ++fi)
+    {
+      const FuncDef& f = sel.functions[fi];
+      std::vector<size_t> overloads;
+      if (is_overloaded(f))
+      {
+        for (size_t j = 0; j < sel.functions.size(); ++j)
+          if (sel.functions[j].name == f.name && sel.functions[j].guards == f.guards) overloads.push_back(j);
+        if (overloads[0] != fi) continue; // registered with the first declaration
+      }
+      for (const auto& g : f.guards) out << g << "\n";
+      size_t arity = js_arity(f);
+      if (!overloads.empty())
+      {
+        // [New] One QJSOverloadSet dispatcher per name; adapters are numbered, plain
+        //       overloads are selected by their signature
+        std::stable_sort(overloads.begin(), overloads.end(), [&](size_t a, size_t b)
+        {
+          return overload_before(parse_params(sel.functions[a].args), parse_params(sel.functions[b].args));
+        });
+        std::vector<std::string> candidates;
+        for (size_t j : overloads)
+        {
+          const FuncDef& o = sel.functions[j];
+          arity = std::min(arity, js_arity(o));
+          std::string types;
+          for (const auto& p : parse_params(o.args)) types += (types.empty() ? "" : ", ") + p.type;
+          candidates.push_back("Wrapper<" + (adapted.count(j) ? adapted[j] :
+            "static_cast<" + o.retType + " (*)(" + types + ")>(" + o.name + ")") + ">");
+        }
+        out << "    JS_CFUNC_DEF(\"" << f.name << "\", " << arity << ", (" << overload_call(candidates) << ")),\n";
+      }
+      else if (!adapted.count(fi) && is_typed_f64(f))
+      {
+        // [New] QuickJS applies ToNumber to each argument and calls the function directly, as
+        //       for Math.hypot: no arity or type check (a missing argument is NaN), and noexcept
+        //       means nothing unwinds through QuickJS. The profiler only sees Wrapper<>::call.
+        out << "#ifdef QJS_PROFILE_BINDING\n";
+        out << "    JS_CFUNC_DEF(\"" << f.name << "\", " << arity << ", (Wrapper<" << f.name << ">::call)),\n";
+        out << "#else\n";
+        out << "    JS_CFUNC_SPECIAL_DEF(\"" << f.name << "\", " << arity << ", " << (arity == 1 ? "f_f" : "f_f_f") <<
+          ", " << f.name << "),\n";
+        out << "#endif\n";
+      }
+      else
+      {
+        std::string target = adapted.count(fi) ? adapted[fi] : f.name;
+        out << "    JS_CFUNC_DEF(\"" << f.name << "\", " << arity << ", (Wrapper<" << target << ">::call)),\n";
+      }
+      if (is_batchable(f))
+        out << "    JS_CFUNC_DEF(\"" << f.name << "_batch\", " << arity << ", (Wrapper<" << f.name <<
+          ">::call_batch)),\n";
+      if (is_async(f))
+      {
+        std::string target = adapted.count(fi) ? adapted[fi] : f.name;
+        out << "    JS_CFUNC_DEF(\"" << f.name << "_async\", " << arity << ", (QJSAsync<" << target << ">::call)),\n";
+      }
+      for (size_t i = 0; i < f.guards.size(); ++i) out << "#endif\n";
+    }
+    for (const auto& m : sel.macros)
     {
       for (const auto& g : m.guards) out << g << "\n";
       if (m.value.find('"') != std::string::npos)
@@ -634,72 +1486,185 @@ public:
       else out << "    JS_PROP_DOUBLE_DEF(\"" << m.name << "\", " << m.value << ", JS_PROP_CONFIGURABLE),\n";
       for (size_t i = 0; i < m.guards.size(); ++i) out << "#endif\n";
     }
-    out << "};\n\n";
-
-    out << "extern \"C\" JSModuleDef* js_init_module_" << moduleName << "(JSContext* ctx, const char* module_name) {\n";
-    out << "    JSModuleDef* m = JS_NewCModule(ctx, module_name, [](JSContext* ctx, JSModuleDef* m) {\n";
-    for (const auto& s : structs)
+    if (primary && funcList)
+      out << "#ifdef QJS_PROFILE_BINDING\n    JS_CFUNC_DEF(\"__bindingStats\", 0, qjs_binding_stats_js),\n#endif\n";
+    else if (primary) out << "    JS_CFUNC_DEF(\"__bindingStats\", 0, qjs_binding_stats_js),\n";
+    if (funcList || primary) out << "};\n" << listEnd << "\n";
+    // Part entry points: `init` runs inside the module init callback, `declare` before it.
+    std::string linkage = exported ? "int " : "static int ";
+    out << linkage << "js_" << prefix << "_init(JSContext* ctx, JSModuleDef* m) {\n";
+    for (const auto& s : sel.structs)
     {
+      for (const auto& g : s.guards) out << g << "\n";
+      std::string classId = "js_" + s.name + "_class_id";
+      out << "    {\n";
+      bool assignable = std::any_of(s.fields.begin(), s.fields.end(), [&](const FieldDef& f) { return is_type_safe_for_binding(f.type); });
+      out << "    qjs_class_id<" << s.name << ">(JS_GetRuntime(ctx)" << (lazyInit ? ", js_" + s.name + "_materialize" : "") <<
+        (assignable ? std::string(lazyInit ? "" : ", nullptr") + ", js_" + s.name + "_assign_into" : "") << ");\n";
+      if (lazyInit)
       {
-        for (const auto& g : s.guards) out << g << "\n";
-        std::string classId = "js_" + s.name + "_class_id";
-        out << "        {\n";
-        out << "        JS_NewClassID(JS_GetRuntime(ctx),&" << classId << ");\n";
-        out << "        JSClassIdTraits<" << s.name << ">::id = " << classId << ";\n";
-        out << "        JSClassDef def = { \"" << s.name << "\", .finalizer = js_" << s.name << "_finalizer };\n";
-        out << "        JS_NewClass(JS_GetRuntime(ctx), " << classId << ", &def);\n";
-        out << "        JSValue proto = JS_NewObject(ctx);\n";
-        out << "        JS_SetPropertyFunctionList(ctx, proto, js_" << s.name << "_proto_funcs, sizeof(js_" << s.name <<
+        out << "    JSValue ctor = JS_NewCFunction2(ctx, js_" << s.name << "_ctor, \"" << s.name <<
+          "\", 0, JS_CFUNC_constructor, 0);\n";
+      }
+      else
+      {
+        out << "    JSClassDef def = { \"" << s.name << "\", .finalizer = js_" << s.name << "_finalizer, .gc_mark = js_" << s.name <<
+          "_gc_mark };\n";
+        out << "    if (qjs_register_class(ctx, " << classId << ", &def) < 0) return -1;\n";
+        out << "    JSValue proto = JS_NewObject(ctx);\n";
+        out << "    JS_SetPropertyFunctionList(ctx, proto, js_" << s.name << "_proto_funcs, sizeof(js_" << s.name <<
           "_proto_funcs)/sizeof(JSCFunctionListEntry));\n";
-        out << "        JS_SetClassProto(ctx, " << classId << ", proto);\n";
-        out << "        JSValue ctor = JS_NewCFunction2(ctx, js_" << s.name << "_ctor, \"" << s.name <<
+        out << "    JS_SetClassProto(ctx, " << classId << ", proto);\n";
+        out << "    JSValue ctor = JS_NewCFunction2(ctx, js_" << s.name << "_ctor, \"" << s.name <<
           "\", 0, JS_CFUNC_constructor, 0);\n";
-        out << "        JS_SetConstructor(ctx, ctor, proto);\n";
-        out << "        JS_SetModuleExport(ctx, m, \"" << s.name << "\", ctor);\n";
-        out << "        }\n";
-        for (size_t i = 0; i < s.guards.size(); ++i) out << "    #endif\n";
+        out << "    JS_SetConstructor(ctx, ctor, proto);\n";
       }
+      if (has_static_funcs(s))
+        out << "    JS_SetPropertyFunctionList(ctx, ctor, js_" << s.name << "_static_funcs, sizeof(js_" << s.name <<
+          "_static_funcs)/sizeof(JSCFunctionListEntry));\n";
+      out << "    JS_SetModuleExport(ctx, m, \"" << s.name << "\", ctor);\n";
+      out << "    }\n";
+      for (size_t i = 0; i < s.guards.size(); ++i) out << "#endif\n";
+    }
+    if (funcList || primary)
+      out << listGuard << "    if (JS_SetModuleExportList(ctx, m, js_" << prefix << "_funcs, sizeof(js_" << prefix <<
+        "_funcs)/sizeof(JSCFunctionListEntry)) != 0) return -1;\n" << listEnd;
+    if (!sel.enums.empty())
+    {
+      out << "    const JSAtom* atoms = js_" << prefix << "_atoms(ctx);\n";
+      out << "    if (!atoms) return -1;\n";
     }
-    out << "        if (JS_SetModuleExportList(ctx, m, js_" << moduleName << "_funcs, sizeof(js_" << moduleName <<
-      "_funcs)/sizeof(JSCFunctionListEntry)) != 0) return -1;\n";
-    for (const auto& e : enums)
+    for (const auto& e : sel.enums)
     {
-      for (const auto& g : e.guards) out << "    " << g << "\n";
-      out << "        {\n            JSValue enum_obj = JS_NewObject(ctx);\n";
+      for (const auto& g : e.guards) out << g << "\n";
+      out << "    {\n        JSValue enum_obj = JS_NewObject(ctx);\n";
       for (const auto& mem : e.members)
       {
-        if (mem.second.empty())
-          out << "            JS_SetPropertyStr(ctx, enum_obj, \"" << mem.first <<
-            "\", JS_NewInt32(ctx, 0));\n";
-        else
-          out << "            JS_SetPropertyStr(ctx, enum_obj, \"" << mem.first << "\", JS_NewInt32(ctx, (int32_t)("
-            << mem.second << ")));\n";
+        std::string value = mem.second.empty() ? "0" : "(int32_t)(" + mem.second + ")";
+        out << "        JS_DefinePropertyValue(ctx, enum_obj, " << atom_ref(mem.first) << ", JS_NewInt32(ctx, " <<
+          value << "), JS_PROP_C_W_E);\n";
       }
-      out << "            JS_SetModuleExport(ctx, m, \"" << e.name << "\", enum_obj);\n        }\n";
-      for (size_t i = 0; i < e.guards.size(); ++i) out << "    #endif\n";
+      out << "        JS_SetModuleExport(ctx, m, \"" << e.name << "\", enum_obj);\n    }\n";
+      for (size_t i = 0; i < e.guards.size(); ++i) out << "#endif\n";
     }
-    out << "        return 0;\n    });\n";
-    out << "    if (!m) return nullptr;\n";
-    out << "    JS_AddModuleExportList(ctx, m, js_" << moduleName << "_funcs, sizeof(js_" << moduleName <<
-      "_funcs)/sizeof(JSCFunctionListEntry));\n";
-    for (const auto& e : enums)
+    out << "    return 0;\n}\n\n";
+
+    out << linkage << "js_" << prefix << "_declare(JSContext* ctx, JSModuleDef* m) {\n";
+    if (funcList || primary)
+      out << listGuard << "    JS_AddModuleExportList(ctx, m, js_" << prefix << "_funcs, sizeof(js_" << prefix <<
+        "_funcs)/sizeof(JSCFunctionListEntry));\n" << listEnd;
+    for (const auto& e : sel.enums)
     {
-      for (const auto& g : e.guards) out << "    " << g << "\n";
+      for (const auto& g : e.guards) out << g << "\n";
       out << "    JS_AddModuleExport(ctx, m, \"" << e.name << "\");\n";
-      for (size_t i = 0; i < e.guards.size(); ++i) out << "    #endif\n";
+      for (size_t i = 0; i < e.guards.size(); ++i) out << "#endif\n";
     }
-    for (const auto& s : structs)
+    for (const auto& s : sel.structs)
     {
-      for (const auto& g : s.guards) out << "    " << g << "\n";
+      for (const auto& g : s.guards) out << g << "\n";
       out << "    JS_AddModuleExport(ctx, m, \"" << s.name << "\");\n";
-      for (size_t i = 0; i < s.guards.size(); ++i) out << "    #endif\n";
+      for (size_t i = 0; i < s.guards.size(); ++i) out << "#endif\n";
     }
+    out << "    return 0;\n}\n";
+
+    std::ofstream outFile(path.string());
+    outFile << "// Generated by Project Gemini\n";
+    outFile << "#include \"quickjs.h\"\n#include \"qjs_utils.hpp\"\n#include <boost/json.hpp>\n";
+    for (const auto& inc : includes)
+    {
+      if (inc.empty()) continue;
+      if (inc.find('<') == std::string::npos && inc.find('"') == std::string::npos)
+        outFile << "#include \"" << inc <<
+          "\"\n";
+      else outFile << "#include " << inc << "\n";
+    }
+    if (!atomNames.empty())
+    {
+      // The tag is TU-local so every shard gets its own per-runtime atom table.
+      outFile << "\nstatic const char* const js_" << prefix << "_atom_names[] = {\n";
+      for (const auto& name : atomNames) outFile << "    \"" << name << "\",\n";
+      outFile << "};\n";
+      outFile << "namespace { struct js_" << prefix << "_atom_tag; }\n";
+      outFile << "static inline const JSAtom* js_" << prefix << "_atoms(JSContext* ctx) {\n";
+      outFile << "    return qjs_atoms<js_" << prefix << "_atom_tag>(ctx, js_" << prefix << "_atom_names, " <<
+        atomNames.size() << ");\n";
+      outFile << "}\n\n";
+    }
+    outFile << out.str();
+  }
+
+  // Writes js_init_module_<module>, which drives the `_init` / `_declare` entry points of
+  // every part (the whole module, or each shard).
+  void emit_module_init(std::ostream& out, const std::vector<std::string>& parts)
+  {
+    out << "\nextern \"C\" JSModuleDef* js_init_module_" << moduleName <<
+      "(JSContext* ctx, const char* module_name) {\n";
+    out << "    JSModuleDef* m = JS_NewCModule(ctx, module_name, [](JSContext* ctx, JSModuleDef* m) {\n";
+    for (const auto& part : parts) out << "        if (js_" << part << "_init(ctx, m) != 0) return -1;\n";
+    out << "        return 0;\n    });\n";
+    out << "    if (!m) return nullptr;\n";
+    for (const auto& part : parts) out << "    js_" << part << "_declare(ctx, m);\n";
     out << "    return m;\n}\n";
-    out.close();
+
+    // Binding template: the init above runs once per runtime, later contexts reuse its exports.
+    out << "\nnamespace { struct js_" << moduleName << "_template_tag; }\n";
+    out << "extern \"C\" JSModuleDef* js_init_module_" << moduleName <<
+      "_from_template(JSContext* ctx, const char* module_name) {\n";
+    out << "    return qjs_attach_module_template<js_" << moduleName << "_template_tag>(ctx, module_name, js_init_module_"
+      << moduleName << ");\n}\n";
+    out << "extern \"C\" void js_release_module_template_" << moduleName << "(JSRuntime* rt) {\n";
+    out << "    qjs_release_module_template<js_" << moduleName << "_template_tag>(rt);\n}\n";
+  }
+
+  void generate()
+  {
+    fs::path outCppPath = fs::path(outputDir) / (moduleName + "_bind.cpp");
+    fs::path outHPath = fs::path(outputDir) / (moduleName + "_bind.h");
+    fs::path outTSPath = fs::path(outputDir) / (moduleName + ".d.ts");
+
+    if (shardCount == 0)
+    {
+      HeaderModel all{functions, enums, macros, structs, callbacks};
+      emit_translation_unit(outCppPath, extraIncludes, all, moduleName, false, true);
+      std::ofstream outFile(outCppPath.string(), std::ios::app);
+      emit_module_init(outFile, {moduleName});
+    }
+    else
+    {
+      std::vector<Shard> shards = plan_shards();
+      std::vector<std::string> parts;
+      for (size_t i = 0; i < shards.size(); ++i)
+      {
+        std::vector<std::string> includes = extraIncludes;
+        for (const auto& h : shards[i].headers)
+          if (std::find(includes.begin(), includes.end(), h) == includes.end()) includes.push_back(h);
+        std::string part = moduleName + "_" + std::to_string(i);
+        emit_translation_unit(fs::path(outputDir) / (moduleName + "_bind_" + std::to_string(i) + ".cpp"), includes,
+                              shards[i].model, part, true, i == 0);
+        parts.push_back(part);
+      }
+      // Registration TU: only forward declarations, so it never recompiles for header edits.
+      std::ofstream outFile(outCppPath.string());
+      outFile << "// Generated by Project Gemini\n";
+      outFile << "#include \"quickjs.h\"\n#include \"qjs_utils.hpp\"\n\n";
+      for (const auto& part : parts)
+      {
+        outFile << "int js_" << part << "_init(JSContext* ctx, JSModuleDef* m);\n";
+        outFile << "int js_" << part << "_declare(JSContext* ctx, JSModuleDef* m);\n";
+      }
+      emit_module_init(outFile, parts);
+    }
 
     std::ofstream outH(outHPath.string());
     outH << "#pragma once\n#include \"quickjs.h\"\n#ifdef __cplusplus\nextern \"C\" {\n#endif\n";
     outH << "JSModuleDef* js_init_module_" << moduleName << "(JSContext* ctx, const char* module_name);\n";
+    outH << "// Same as js_init_module_" << moduleName << ", but the bindings are built once per JSRuntime (in a\n";
+    outH << "// private context) and every later context re-exports them. Bound functions run in that\n";
+    outH << "// context's realm and the exports are shared between contexts.\n";
+    outH << "JSModuleDef* js_init_module_" << moduleName <<
+      "_from_template(JSContext* ctx, const char* module_name);\n";
+    outH << "// Frees the runtime's template. Call before JS_FreeRuntime.\n";
+    outH << "void js_release_module_template_" << moduleName << "(JSRuntime* rt);\n";
     outH << "#ifdef __cplusplus\n}\n#endif\n";
     outH.close();
 
@@ -777,30 +1742,101 @@ public:
     for (const auto& s : structs)
     {
       outTS << "export class " << s.name << " {\n";
+      std::stringstream shape;
       for (const auto& f : s.fields)
       {
         if (!is_type_safe_for_binding(f.type)) continue;
         outTS << "  " << f.name << ": " << cpp_to_ts_type(f.type) << ";\n";
+        shape << " " << f.name << ": " << cpp_to_ts_type(f.type) << ";";
       }
-      outTS << "  toJson(): string;\n}\n\n";
+      outTS << "  toJson(): string;\n";
+      outTS << "  toObject(): {" << shape.str() << " };\n";
+      outTS << "  snapshot(): {" << shape.str() << " };\n";
+      outTS << "  assign(values: Partial<{" << shape.str() << " }>): this;\n";
+      outTS << "  toBuffer(): ArrayBuffer;\n";
+      // Overloads that differ only in C++ types (int / double) collapse to one TS signature
+      std::set<std::string> declared;
+      auto declare = [&](const std::string& sig) { if (declared.insert(sig).second) outTS << "  " << sig << ";\n"; };
+      for (const auto& m : bound_methods(s, false))
+        declare(m.name + "(" + format_ts_args(m.args, false, true) + "): " + cpp_to_ts_type(m.retType));
+      std::vector<std::vector<ParamDef>> ctors = ctor_signatures(s);
+      if (!s.ctors.empty() && ctors.empty()) outTS << "  private constructor();\n";
+      for (const auto& sig : ctors)
+      {
+        std::string args;
+        for (const auto& p : sig) args += (args.empty() ? "" : ", ") + p.type + " " + p.name;
+        declare("constructor(" + format_ts_args(args) + ")");
+      }
+      if (is_default_constructible(s))
+        outTS << "  static fromBuffer(buf: ArrayBuffer | Uint8Array): " << s.name << ";\n";
+      for (const auto& m : bound_methods(s, true))
+        declare("static " + m.name + "(" + format_ts_args(m.args, false, true) + "): " + cpp_to_ts_type(m.retType));
+      outTS << "}\n\n";
     }
+    std::set<std::string> declared; // overloads: one TS signature per distinct JS shape
     for (const auto& f : functions)
     {
-      outTS << "export function " << f.name << "(" << format_ts_args(f.args) << "): " << cpp_to_ts_type(f.retType) <<
-        ";\n";
+      std::string sig = "export function " + f.name + "(" + format_ts_args(f.args, queuedFunctions.count(f.name) > 0) +
+        "): " + cpp_to_ts_type(f.retType) + ";\n";
+      if (declared.insert(sig).second) outTS << sig;
+      if (is_async(f))
+        outTS << "export function " << f.name << "_async(" << format_ts_args(f.args) << "): Promise<" <<
+          cpp_to_ts_type(f.retType) << ">;\n";
+      if (!is_batchable(f)) continue;
+      std::string retArray = strip_cv_ref(f.retType) == "void" ? "" : ts_typed_array(f.retType);
+      outTS << "export function " << f.name << "_batch(";
+      for (const auto& p : parse_params(f.args))
+        outTS << p.name << ": " << ts_typed_array(p.type) << " | number, ";
+      if (retArray.empty()) outTS << "): void;\n";
+      else outTS << "out?: " << retArray << "): " << retArray << ";\n";
     }
+    outTS << "\n/** Per-binding call statistics; only present when built with QJS_PROFILE_BINDING. */\n";
+    outTS << "export function __bindingStats(reset?: boolean): Array<{ name: string; calls: number; args_ns: number; "
+      "native_ns: number; return_ns: number; total_ns: number }>;\n";
     outTS.close();
   }
 };
 
+// Usage: qjs_bind_gen [--no_pool=Struct]... [--header=extra.h]... [--shards=N]
+//                     [--lazy_init] [--borrowed=func]... [--async=func]... [--queued=func]...
+//                     [--retained=func]... <header> <out_dir> <module_name> [include]...
+// With --shards=N the bindings are split into <module>_bind_0..N-1.cpp and <module>_bind.cpp
+// only holds the module registration. --lazy_init defers class registration and prototypes
+// until a struct is first used in a context. --borrowed=func is the same as annotating the
+// declaration with QJS_BORROWED (--borrowed=Struct::method for member functions), --async=func
+// with QJS_ASYNC, --queued=func with QJS_QUEUED, --retained=func with QJS_RETAINED.
 int main(int argc, char** argv)
 {
-  if (argc < 4) return 1;
-  std::vector<std::string> includes;
-  for (int i = 4; i < argc; ++i) includes.emplace_back(argv[i]);
+  std::vector<std::string> positional;
+  std::set<std::string> noPool;
+  std::vector<std::string> extraHeaders;
+  size_t shards = 0;
+  bool lazyInit = false;
+  std::set<std::string> borrowed;
+  std::set<std::string> async;
+  std::set<std::string> queued;
+  std::set<std::string> retained;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (boost::starts_with(arg, "--no_pool=")) noPool.insert(arg.substr(10));
+    else if (boost::starts_with(arg, "--header=")) extraHeaders.push_back(arg.substr(9));
+    else if (boost::starts_with(arg, "--shards=")) shards = std::stoul(arg.substr(9));
+    else if (arg == "--lazy_init") lazyInit = true;
+    else if (boost::starts_with(arg, "--borrowed=")) borrowed.insert(arg.substr(11));
+    else if (boost::starts_with(arg, "--async=")) async.insert(arg.substr(8));
+    else if (boost::starts_with(arg, "--queued=")) queued.insert(arg.substr(9));
+    else if (boost::starts_with(arg, "--retained=")) retained.insert(arg.substr(11));
+    else positional.push_back(arg);
+  }
+  if (positional.size() < 3) return 1;
+  std::vector<std::string> includes(positional.begin() + 3, positional.end());
+  std::vector<std::string> headers = {positional[0]};
+  headers.insert(headers.end(), extraHeaders.begin(), extraHeaders.end());
   try
   {
-    BindingGenerator gen(argv[1], argv[2], argv[3], includes);
+    BindingGenerator gen(headers, positional[1], positional[2], includes, noPool, shards, lazyInit, borrowed,
+                         async, queued, retained);
     gen.parse();
     gen.generate();
   }
@@ -0,0 +1,1108 @@
+#pragma once
+
+// Header model shared by the generator and its parsers, plus the single-pass
+// tokenizer / declaration parser that fills it.
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct GuardState
+{
+  std::string line;
+  std::string symbol;
+  bool isHeaderGuard;
+};
+
+struct FuncDef
+{
+  std::string retType, name, args;
+  std::vector<std::string> guards;
+  bool isNoexcept = false; // `noexcept` or `noexcept(true)`
+};
+
+struct EnumDef
+{
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> members;
+  std::vector<std::string> guards;
+};
+
+struct MacroDef
+{
+  std::string name, value;
+  std::vector<std::string> guards;
+};
+
+struct FieldDef
+{
+  std::string type;
+  std::string name;
+  bool bitfield = false; // no member pointer: bound through its own accessors
+};
+
+// `typedef Ret (*Name)(Args);`, bindable as a callback parameter.
+struct CallbackDef
+{
+  std::string name, retType, args;
+  std::vector<std::string> guards;
+};
+
+// [New] A public member function: bound onto the prototype, or onto the constructor when static.
+struct MethodDef
+{
+  std::string retType, name, args;
+  bool isConst = false;
+  bool isStatic = false;
+};
+
+struct StructDef
+{
+  std::string name;
+  std::vector<FieldDef> fields;
+  std::vector<MethodDef> methods;
+  std::vector<std::string> ctors; // argument lists of the public constructors
+  std::vector<std::string> guards;
+};
+
+struct HeaderModel
+{
+  std::vector<FuncDef> functions;
+  std::vector<EnumDef> enums;
+  std::vector<MacroDef> macros;
+  std::vector<StructDef> structs;
+  std::vector<CallbackDef> callbacks;
+};
+
+// --- Shared helpers ---
+
+inline int evaluate_expression(std::string expr, const std::map<std::string, int>& symbolTable)
+{
+  expr.erase(std::remove(expr.begin(), expr.end(), ' '), expr.end());
+  if (expr.empty()) return 0;
+  size_t barPos = expr.find('|');
+  if (barPos != std::string::npos)
+    return evaluate_expression(expr.substr(0, barPos), symbolTable) |
+      evaluate_expression(expr.substr(barPos + 1), symbolTable);
+  if (expr.length() > 2 && expr.front() == '(' && expr.back() == ')')
+    return evaluate_expression(
+      expr.substr(1, expr.length() - 2), symbolTable);
+  size_t shiftPos = expr.find("<<");
+  if (shiftPos != std::string::npos)
+    return evaluate_expression(expr.substr(0, shiftPos), symbolTable) <<
+      evaluate_expression(expr.substr(shiftPos + 2), symbolTable);
+  size_t plusPos = expr.find("+");
+  if (plusPos != std::string::npos)
+    return evaluate_expression(expr.substr(0, plusPos), symbolTable) +
+      evaluate_expression(expr.substr(plusPos + 1), symbolTable);
+  if (expr.find("0x") == 0 || expr.find("0X") == 0)
+    try { return std::stoul(expr, nullptr, 16); }
+    catch (...) { return 0; }
+  if (isdigit(expr[0]) || (expr.length() > 1 && expr[0] == '-'))
+    try { return std::stoi(expr); }
+    catch (...) { return 0; }
+  if (symbolTable.count(expr)) return symbolTable.at(expr);
+  return 0;
+}
+
+// Naming heuristics for callback / descriptor types the bindings cannot marshal.
+inline bool is_unbindable_signature(const std::string& rawRet, const std::string& rawArgs)
+{
+  static const char* const markers[] = {
+    "(*", "_cb_t", "_cb", "_walker", "_dsc_t", "_rb_compare_t", "_f_t", "_handler_t", "d2_"
+  };
+  if (rawArgs.find("...") != std::string::npos) return true;
+  for (const char* m : markers)
+    if (rawArgs.find(m) != std::string::npos || rawRet.find(m) != std::string::npos) return true;
+  return false;
+}
+
+// Drops the parameters the generator can bind as callbacks (inline function pointers,
+// std::function and callback typedefs in `callbackTypes`), so the naming heuristics above
+// only judge the rest of the signature.
+inline std::string without_callback_params(const std::string& rawArgs, const std::set<std::string>& callbackTypes)
+{
+  std::string out, cur;
+  int depth = 0;
+  auto flush = [&]
+  {
+    std::string compact, word;
+    bool typedefParam = false;
+    for (char c : cur + " ")
+    {
+      if (!isspace(static_cast<unsigned char>(c))) compact += c;
+      if (isalnum(static_cast<unsigned char>(c)) || c == '_') word += c;
+      else
+      {
+        if (callbackTypes.count(word)) typedefParam = true;
+        word.clear();
+      }
+    }
+    bool callback = compact.find("(*") != std::string::npos || compact.find("std::function<") != std::string::npos ||
+      typedefParam;
+    if (!callback)
+    {
+      if (!out.empty()) out += ",";
+      out += cur;
+    }
+    cur.clear();
+  };
+  for (char c : rawArgs)
+  {
+    if (c == '(' || c == '<') depth++;
+    else if ((c == ')' || c == '>') && depth > 0) depth--;
+    if (c == ',' && depth == 0)
+    {
+      flush();
+      continue;
+    }
+    cur += c;
+  }
+  flush();
+  return out;
+}
+
+inline bool is_callback_field_type(const std::string& type)
+{
+  auto ends_with = [&](const char* suffix)
+  {
+    size_t n = std::char_traits<char>::length(suffix);
+    return type.size() >= n && type.compare(type.size() - n, n, suffix) == 0;
+  };
+  return ends_with("_cb_t") || ends_with("_walker");
+}
+
+// --- Tokenizer ---
+
+enum class TokKind { Ident, Number, String, Char, Punct, Directive, End };
+
+struct Token
+{
+  TokKind kind = TokKind::End;
+  std::string_view text;
+  bool spaceBefore = false; // whitespace or a comment separates it from the previous token
+
+  bool is(std::string_view s) const { return kind != TokKind::String && text == s; }
+};
+
+// Streams tokens out of a header in one pass. Comments are dropped; a preprocessor
+// line (including `\` continuations) comes back as a single Directive token.
+class HeaderLexer
+{
+  std::string_view src;
+  size_t pos = 0;
+  bool lineStart = true;
+
+  bool at(size_t i, char c) const { return i < src.size() && src[i] == c; }
+
+  static bool ident_start(char c) { return isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '$'; }
+  static bool ident_char(char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$'; }
+
+  // Skips whitespace and comments; reports whether anything was skipped.
+  bool skip_trivia()
+  {
+    size_t start = pos;
+    while (pos < src.size())
+    {
+      char c = src[pos];
+      if (c == '\n')
+      {
+        lineStart = true;
+        pos++;
+      }
+      else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') pos++;
+      else if (c == '\\' && (at(pos + 1, '\n') || (at(pos + 1, '\r') && at(pos + 2, '\n'))))
+        pos += at(pos + 1, '\n') ? 2 : 3;
+      else if (c == '/' && at(pos + 1, '/'))
+      {
+        while (pos < src.size() && src[pos] != '\n') pos++;
+      }
+      else if (c == '/' && at(pos + 1, '*'))
+      {
+        size_t end = src.find("*/", pos + 2);
+        pos = end == std::string_view::npos ? src.size() : end + 2;
+      }
+      else break;
+    }
+    return pos != start;
+  }
+
+  void skip_quoted(char quote)
+  {
+    pos++;
+    while (pos < src.size() && src[pos] != quote && src[pos] != '\n')
+    {
+      if (src[pos] == '\\') pos++;
+      pos++;
+    }
+    if (pos < src.size() && src[pos] == quote) pos++;
+  }
+
+  // Runs to the end of a preprocessor line, following continuations and block comments.
+  void skip_directive()
+  {
+    while (pos < src.size() && src[pos] != '\n')
+    {
+      char c = src[pos];
+      if (c == '\\' && (at(pos + 1, '\n') || (at(pos + 1, '\r') && at(pos + 2, '\n'))))
+        pos += at(pos + 1, '\n') ? 2 : 3;
+      else if (c == '"' || c == '\'') skip_quoted(c);
+      else if (c == '/' && at(pos + 1, '*'))
+      {
+        size_t end = src.find("*/", pos + 2);
+        pos = end == std::string_view::npos ? src.size() : end + 2;
+      }
+      else if (c == '/' && at(pos + 1, '/'))
+      {
+        while (pos < src.size() && src[pos] != '\n') pos++;
+      }
+      else pos++;
+    }
+  }
+
+public:
+  explicit HeaderLexer(std::string_view source) : src(source) {}
+
+  Token next()
+  {
+    Token tok;
+    tok.spaceBefore = skip_trivia();
+    if (pos >= src.size()) return tok;
+    size_t start = pos;
+    char c = src[pos];
+    bool directive = lineStart && c == '#';
+    lineStart = false;
+
+    if (directive)
+    {
+      skip_directive();
+      tok.kind = TokKind::Directive;
+    }
+    else if (c == 'R' && at(pos + 1, '"'))
+    {
+      // Raw string literal: R"delim( ... )delim"
+      size_t open = src.find('(', pos + 2);
+      std::string close = ")" + std::string(src.substr(pos + 2, open == std::string_view::npos ? 0 : open - pos - 2)) + "\"";
+      size_t end = open == std::string_view::npos ? std::string_view::npos : src.find(close, open);
+      pos = end == std::string_view::npos ? src.size() : end + close.size();
+      tok.kind = TokKind::String;
+    }
+    else if (ident_start(c))
+    {
+      while (pos < src.size() && ident_char(src[pos])) pos++;
+      // Encoding prefixes (u8"", L'') belong to the literal.
+      if (pos < src.size() && (src[pos] == '"' || src[pos] == '\'') && pos - start <= 2)
+      {
+        std::string_view prefix = src.substr(start, pos - start);
+        if (prefix == "L" || prefix == "u" || prefix == "U" || prefix == "u8")
+        {
+          tok.kind = src[pos] == '"' ? TokKind::String : TokKind::Char;
+          skip_quoted(src[pos]);
+          tok.text = src.substr(start, pos - start);
+          return tok;
+        }
+      }
+      tok.kind = TokKind::Ident;
+    }
+    else if (isdigit(static_cast<unsigned char>(c)) || (c == '.' && pos + 1 < src.size() &&
+      isdigit(static_cast<unsigned char>(src[pos + 1]))))
+    {
+      // pp-number: digits, letters, '.', digit separators and signed exponents
+      pos++;
+      while (pos < src.size())
+      {
+        char d = src[pos];
+        if ((d == '+' || d == '-') && (src[pos - 1] == 'e' || src[pos - 1] == 'E' || src[pos - 1] == 'p' ||
+          src[pos - 1] == 'P'))
+          pos++;
+        else if (ident_char(d) || d == '.' || d == '\'') pos++;
+        else break;
+      }
+      tok.kind = TokKind::Number;
+    }
+    else if (c == '"' || c == '\'')
+    {
+      skip_quoted(c);
+      tok.kind = c == '"' ? TokKind::String : TokKind::Char;
+    }
+    else
+    {
+      // '>' is never merged so nested template closers (`>>`) stay balanced.
+      static const char* const multi[] = {
+        "...", "::", "->", "<<", "<=", "==", "!=", "&&", "||", "##", "++", "--",
+        "+=", "-=", "*=", "/=", "|=", "&=", "^=", "%="
+      };
+      size_t len = 1;
+      for (const char* m : multi)
+      {
+        size_t n = std::char_traits<char>::length(m);
+        if (src.compare(pos, n, m) == 0)
+        {
+          len = n;
+          break;
+        }
+      }
+      pos += len;
+      tok.kind = TokKind::Punct;
+    }
+    tok.text = src.substr(start, pos - start);
+    return tok;
+  }
+};
+
+// --- Declaration Parser ---
+
+// Recursive-descent parser over HeaderLexer tokens. Each top-level declaration is
+// collected once (brace-balanced) and then classified, so the whole header is
+// processed in linear time. It fills the same model as the regex parser it replaced.
+class HeaderParser
+{
+  HeaderLexer lexer;
+  std::deque<Token> lookahead;
+  std::vector<GuardState> guardStack;
+  int externDepth = 0;
+  HeaderModel model;
+  std::set<std::string> callbackTypes; // names in model.callbacks, for the signature filter
+
+  using Tokens = std::vector<Token>;
+
+  // --- token stream (directives are consumed here, wherever they appear) ---
+
+  Token pull()
+  {
+    while (true)
+    {
+      Token t = lexer.next();
+      if (t.kind != TokKind::Directive) return t;
+      handle_directive(normalize_directive(t.text));
+    }
+  }
+
+  const Token& peek()
+  {
+    if (lookahead.empty()) lookahead.push_back(pull());
+    return lookahead.front();
+  }
+
+  Token take()
+  {
+    if (lookahead.empty()) return pull();
+    Token t = lookahead.front();
+    lookahead.pop_front();
+    return t;
+  }
+
+  // --- text helpers ---
+
+  static std::string join(const Tokens& toks, size_t from, size_t to)
+  {
+    std::string out;
+    for (size_t i = from; i < to && i < toks.size(); ++i)
+    {
+      if (i > from && toks[i].spaceBefore) out += ' ';
+      out.append(toks[i].text.data(), toks[i].text.size());
+    }
+    return out;
+  }
+
+  static std::string trim(std::string_view s)
+  {
+    size_t b = 0, e = s.size();
+    while (b < e && isspace(static_cast<unsigned char>(s[b]))) b++;
+    while (e > b && isspace(static_cast<unsigned char>(s[e - 1]))) e--;
+    return std::string(s.substr(b, e - b));
+  }
+
+  static size_t match_close(const Tokens& t, size_t open)
+  {
+    std::string_view o = t[open].text;
+    std::string_view c = o == "(" ? ")" : o == "{" ? "}" : o == "[" ? "]" : ">";
+    int depth = 0;
+    for (size_t i = open; i < t.size(); ++i)
+    {
+      if (t[i].kind != TokKind::Punct) continue;
+      if (t[i].text == o) depth++;
+      else if (t[i].text == c && --depth == 0) return i;
+    }
+    return t.size();
+  }
+
+  // Drops [[...]], __attribute__((...)), __declspec(...) and alignas(...).
+  static Tokens strip_attributes(const Tokens& in)
+  {
+    Tokens out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+      const Token& t = in[i];
+      if (t.is("[") && i + 1 < in.size() && in[i + 1].is("["))
+      {
+        i = match_close(in, i);
+        continue;
+      }
+      if ((t.is("__attribute__") || t.is("__declspec") || t.is("alignas")) && i + 1 < in.size() && in[i + 1].is("("))
+      {
+        i = match_close(in, i + 1);
+        continue;
+      }
+      out.push_back(t);
+    }
+    return out;
+  }
+
+  static bool is_storage_keyword(const Token& t)
+  {
+    return t.is("inline") || t.is("static") || t.is("constexpr") || t.is("extern") || t.is("virtual") ||
+      t.is("explicit") || t.is("mutable");
+  }
+
+  // Type text with storage keywords removed (what clean_type_string used to do).
+  static std::string clean_type(const Tokens& t, size_t from, size_t to)
+  {
+    Tokens kept;
+    for (size_t i = from; i < to && i < t.size(); ++i)
+      if (!is_storage_keyword(t[i])) kept.push_back(t[i]);
+    return join(kept, 0, kept.size());
+  }
+
+  // --- preprocessor ---
+
+  // "#  if  X // note" -> "#if X"; continuations become spaces, comments are removed.
+  static std::string normalize_directive(std::string_view raw)
+  {
+    std::string out;
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+      char c = raw[i];
+      if (c == '\\' && i + 1 < raw.size() && (raw[i + 1] == '\n' || raw[i + 1] == '\r'))
+      {
+        while (i + 1 < raw.size() && (raw[i + 1] == '\n' || raw[i + 1] == '\r')) i++;
+        out += ' ';
+      }
+      else if (c == '"' || c == '\'')
+      {
+        size_t j = i + 1;
+        while (j < raw.size() && raw[j] != c)
+        {
+          if (raw[j] == '\\') j++;
+          j++;
+        }
+        out.append(raw.substr(i, j + 1 - i));
+        i = j;
+      }
+      else if (c == '/' && i + 1 < raw.size() && raw[i + 1] == '/') break;
+      else if (c == '/' && i + 1 < raw.size() && raw[i + 1] == '*')
+      {
+        size_t end = raw.find("*/", i + 2);
+        if (end == std::string_view::npos) break;
+        out += ' ';
+        i = end + 1;
+      }
+      else out += c;
+    }
+    std::string s = trim(out);
+    size_t nameStart = 1;
+    while (nameStart < s.size() && isspace(static_cast<unsigned char>(s[nameStart]))) nameStart++;
+    size_t nameEnd = nameStart;
+    while (nameEnd < s.size() && isalpha(static_cast<unsigned char>(s[nameEnd]))) nameEnd++;
+    std::string rest = trim(std::string_view(s).substr(nameEnd));
+    return "#" + s.substr(nameStart, nameEnd - nameStart) + (rest.empty() ? "" : " " + rest);
+  }
+
+  static std::string first_word(const std::string& s, size_t from)
+  {
+    size_t b = from;
+    while (b < s.size() && isspace(static_cast<unsigned char>(s[b]))) b++;
+    size_t e = b;
+    while (e < s.size() && (isalnum(static_cast<unsigned char>(s[e])) || s[e] == '_')) e++;
+    return s.substr(b, e - b);
+  }
+
+  static bool starts_with(const std::string& s, const char* prefix)
+  {
+    return s.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+  }
+
+  static std::string invert_guard(const std::string& line)
+  {
+    if (starts_with(line, "#ifdef ")) return "#ifndef " + line.substr(7);
+    if (starts_with(line, "#ifndef ")) return "#ifdef " + line.substr(8);
+    if (starts_with(line, "#if ")) return "#if !(" + trim(line.substr(4)) + ")";
+    return line;
+  }
+
+  std::vector<std::string> active_guards() const
+  {
+    std::vector<std::string> active;
+    for (const auto& g : guardStack) if (!g.isHeaderGuard) active.push_back(g.line);
+    return active;
+  }
+
+  // Object-like macros whose whole value is a string or numeric literal.
+  static bool macro_literal(const std::string& rest, std::string& value)
+  {
+    if (rest.empty()) return false;
+    if (rest[0] == '"')
+    {
+      size_t last = rest.rfind('"');
+      if (last == 0) return false;
+      value = rest.substr(0, last + 1);
+      return true;
+    }
+    size_t i = 0;
+    if (rest[i] == '-') i++;
+    size_t digits = i;
+    if (rest.compare(i, 2, "0x") == 0 || rest.compare(i, 2, "0X") == 0)
+    {
+      i += 2;
+      while (i < rest.size() && isxdigit(static_cast<unsigned char>(rest[i]))) i++;
+      if (i == digits + 2) return false;
+    }
+    else
+    {
+      while (i < rest.size() && isdigit(static_cast<unsigned char>(rest[i]))) i++;
+      if (i == digits) return false;
+      if (i < rest.size() && rest[i] == '.')
+      {
+        i++;
+        while (i < rest.size() && isdigit(static_cast<unsigned char>(rest[i]))) i++;
+      }
+      if (i < rest.size() && (rest[i] == 'e' || rest[i] == 'E'))
+      {
+        size_t e = i + 1;
+        if (e < rest.size() && (rest[e] == '+' || rest[e] == '-')) e++;
+        size_t expDigits = e;
+        while (e < rest.size() && isdigit(static_cast<unsigned char>(rest[e]))) e++;
+        if (e > expDigits) i = e;
+      }
+    }
+    size_t end = i;
+    while (i < rest.size() && (rest[i] == 'u' || rest[i] == 'U' || rest[i] == 'l' || rest[i] == 'L' ||
+      rest[i] == 'f' || rest[i] == 'F'))
+      i++;
+    if (i != rest.size()) return false;
+    value = rest.substr(0, end);
+    return true;
+  }
+
+  void handle_directive(const std::string& line)
+  {
+    std::string name = first_word(line, 1);
+    if (name == "define")
+    {
+      size_t p = line.find("define") + 6;
+      std::string sym = first_word(line, p);
+      if (sym.empty()) return;
+      if (!guardStack.empty() && guardStack.back().symbol == sym)
+      {
+        guardStack.back().isHeaderGuard = true;
+        return;
+      }
+      size_t after = line.find(sym, p) + sym.size();
+      if (after < line.size() && line[after] == '(') return; // function-like
+      bool upper = true;
+      for (char c : sym)
+        if (!(isupper(static_cast<unsigned char>(c)) || isdigit(static_cast<unsigned char>(c)) || c == '_'))
+          upper = false;
+      std::string value;
+      if (upper && macro_literal(trim(std::string_view(line).substr(after)), value))
+        model.macros.push_back({sym, value, active_guards()});
+    }
+    else if (name == "if" || name == "ifdef" || name == "ifndef")
+    {
+      GuardState gs{line, "", false};
+      if (name == "ifndef") gs.symbol = first_word(line, 7);
+      guardStack.push_back(gs);
+    }
+    else if (name == "endif")
+    {
+      if (!guardStack.empty()) guardStack.pop_back();
+    }
+    else if (name == "else")
+    {
+      if (!guardStack.empty())
+      {
+        std::string prev = guardStack.back().line;
+        guardStack.pop_back();
+        guardStack.push_back({invert_guard(prev), "", false});
+      }
+    }
+    else if (name == "elif")
+    {
+      if (!guardStack.empty())
+      {
+        guardStack.pop_back();
+        guardStack.push_back({"#if " + trim(std::string_view(line).substr(5)), "", false});
+      }
+    }
+  }
+
+  // --- declarations ---
+
+  // Collects one top-level declaration, up to its `;` or the `}` closing a body.
+  bool collect(Token first, Tokens& decl, std::vector<std::string>& guards)
+  {
+    int depth = 0;
+    size_t firstBrace = std::string::npos;
+    bool isNamespace = first.is("namespace");
+    Token t = first;
+    while (true)
+    {
+      if (t.kind == TokKind::End) return false;
+      decl.push_back(t);
+      if (t.is("{"))
+      {
+        if (depth++ == 0 && firstBrace == std::string::npos) firstBrace = decl.size() - 1;
+      }
+      else if (t.is("}"))
+      {
+        if (--depth <= 0)
+        {
+          guards = active_guards();
+          if (isNamespace || is_function_body(decl, firstBrace)) return true;
+          if (peek().is(";"))
+          {
+            decl.push_back(take());
+            return true;
+          }
+          depth = 0;
+        }
+      }
+      else if (t.is(";") && depth == 0)
+      {
+        guards = active_guards();
+        return true;
+      }
+      t = take();
+    }
+  }
+
+  static bool is_function_body(const Tokens& decl, size_t brace)
+  {
+    if (brace == std::string::npos || brace == 0) return false;
+    size_t i = brace - 1;
+    while (i > 0 && (decl[i].is("const") || decl[i].is("noexcept") || decl[i].is("override") ||
+      decl[i].is("final") || decl[i].is("volatile") || decl[i].is("&") || decl[i].is("&&")))
+      i--;
+    return decl[i].is(")");
+  }
+
+  void parse_enum(const std::string& name, const Tokens& t, size_t open, size_t close,
+                  const std::vector<std::string>& guards)
+  {
+    // Enums built from function-like macros cannot be evaluated.
+    for (size_t i = open + 1; i + 1 < close; ++i)
+    {
+      if (t[i].kind != TokKind::Ident || !t[i + 1].is("(")) continue;
+      bool upper = isupper(static_cast<unsigned char>(t[i].text[0])) || t[i].text[0] == '_';
+      for (char c : t[i].text)
+        if (!(isupper(static_cast<unsigned char>(c)) || isdigit(static_cast<unsigned char>(c)) || c == '_'))
+          upper = false;
+      if (upper) return;
+    }
+    EnumDef edef;
+    edef.name = name;
+    edef.guards = guards;
+    std::map<std::string, int> symbol_table;
+    int currentVal = 0;
+    size_t i = open + 1;
+    while (i < close)
+    {
+      size_t end = i;
+      int depth = 0;
+      while (end < close)
+      {
+        if (t[end].is("(") || t[end].is("{")) depth++;
+        else if (t[end].is(")") || t[end].is("}")) depth--;
+        else if (t[end].is(",") && depth == 0) break;
+        end++;
+      }
+      if (end > i && t[i].kind == TokKind::Ident)
+      {
+        std::string key(t[i].text);
+        std::string val_str;
+        for (size_t j = i + 1; j < end; ++j)
+        {
+          if (t[j].is("="))
+          {
+            val_str = join(t, j + 1, end);
+            break;
+          }
+        }
+        if (key != "public" && key != "private")
+        {
+          int val = currentVal;
+          if (!val_str.empty())
+          {
+            val = evaluate_expression(val_str, symbol_table);
+            currentVal = val;
+          }
+          symbol_table[key] = val;
+          edef.members.push_back({key, val_str.empty() ? std::to_string(val) : val_str});
+          currentVal++;
+        }
+      }
+      i = end + 1;
+    }
+    if (!edef.members.empty()) model.enums.push_back(edef);
+  }
+
+  // One member declaration inside a struct body -> zero or more data fields.
+  void parse_member(const Tokens& m, StructDef& sdef)
+  {
+    if (m.empty()) return;
+    for (const auto& tok : m)
+    {
+      // methods, function pointers, nested definitions, initializer braces; static data members
+      // have no member pointer and no storage in the instance, so they are not fields
+      if (tok.is("(") || tok.is("{") || tok.is("operator") || tok.is("typedef") || tok.is("using") ||
+        tok.is("friend") || tok.is("template") || tok.is("static_assert") || tok.is("constexpr") ||
+        tok.is("static"))
+        return;
+    }
+    // Split declarators on top-level commas: `int x, *y;`
+    std::vector<std::pair<size_t, size_t>> parts;
+    int angle = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < m.size(); ++i)
+    {
+      if (m[i].is("<")) angle++;
+      else if (m[i].is(">") && angle > 0) angle--;
+      else if (m[i].is(",") && angle == 0)
+      {
+        parts.push_back({start, i});
+        start = i + 1;
+      }
+    }
+    parts.push_back({start, m.size()});
+
+    // The first declarator's name ends the shared specifiers.
+    size_t firstEnd = parts[0].second;
+    for (size_t i = parts[0].first; i < parts[0].second; ++i)
+    {
+      if (m[i].is("=") || m[i].is(":") || m[i].is("["))
+      {
+        firstEnd = i;
+        break;
+      }
+    }
+    size_t nameIdx = firstEnd;
+    while (nameIdx > 0 && m[nameIdx - 1].kind != TokKind::Ident) nameIdx--;
+    if (nameIdx == 0) return;
+    nameIdx--;
+    size_t specEnd = nameIdx;
+    while (specEnd > 0 && (m[specEnd - 1].is("*") || m[specEnd - 1].is("&") || m[specEnd - 1].is("&&")))
+      specEnd--;
+    if (specEnd == 0) return;
+    std::string base = clean_type(m, 0, specEnd);
+
+    for (size_t p = 0; p < parts.size(); ++p)
+    {
+      size_t from = p == 0 ? specEnd : parts[p].first;
+      size_t to = parts[p].second;
+      std::string ptrs;
+      std::string fname;
+      bool isArray = false, constPtr = false, bitfield = false;
+      for (size_t i = from; i < to; ++i)
+      {
+        const Token& tok = m[i];
+        if (tok.is("=") || tok.is(":")) // default member initializer / bit-field width
+        {
+          bitfield = tok.is(":");
+          break;
+        }
+        if (tok.is("[")) isArray = true;
+        else if (tok.is("*") || tok.is("&") || tok.is("&&")) ptrs += std::string(tok.text);
+        else if (tok.is("const")) constPtr = !ptrs.empty();
+        else if (tok.kind == TokKind::Ident && fname.empty()) fname = std::string(tok.text);
+      }
+      if (fname.empty() || isArray || constPtr) continue;
+      std::string type = base + ptrs;
+      // Top-level const values cannot take a setter.
+      if (ptrs.empty() && (base.compare(0, 6, "const ") == 0 || base.find(" const") != std::string::npos)) continue;
+      if (is_callback_field_type(type)) continue;
+      sdef.fields.push_back({type, fname, bitfield});
+    }
+  }
+
+  // [New] One member function declaration (tokens up to its `;`, body or initializer list)
+  // -> a constructor or method. Virtual, deleted, operator and rvalue-qualified members are
+  // skipped, as are signatures the naming heuristics reject (C callbacks are only adapted
+  // for free functions).
+  void parse_method(const Tokens& m, StructDef& sdef)
+  {
+    size_t open = m.size();
+    int angle = 0;
+    for (size_t i = 0; i < m.size(); ++i)
+    {
+      if (m[i].is("<")) angle++;
+      else if (m[i].is(">") && angle > 0) angle--;
+      else if (angle > 0) continue;
+      else if (m[i].is("=") || m[i].is("~") || m[i].is("operator") || m[i].is("virtual") || m[i].is("friend") ||
+        m[i].is("template") || m[i].is("typedef") || m[i].is("using"))
+        return;
+      else if (m[i].is("("))
+      {
+        open = i;
+        break;
+      }
+    }
+    if (open == m.size() || open == 0 || m[open - 1].kind != TokKind::Ident) return;
+    size_t close = match_close(m, open);
+    if (close >= m.size()) return;
+    bool isConst = false;
+    for (size_t i = close + 1; i < m.size() && !m[i].is("{") && !m[i].is(":"); ++i)
+    {
+      if (m[i].is("const")) isConst = true;
+      else if (m[i].is("&&") || m[i].is("override") || m[i].is("final") || m[i].is("delete") || m[i].is("0") ||
+        m[i].is("->"))
+        return;
+    }
+
+    size_t begin = 0;
+    bool isStatic = false;
+    while (begin + 1 < open && is_storage_keyword(m[begin])) isStatic |= m[begin++].is("static");
+    std::string name(m[open - 1].text);
+    std::string args = join(m, open + 1, close);
+    if (begin + 1 == open)
+    {
+      // Constructor; the move constructor adds nothing over the copy constructor in JS
+      std::string compact;
+      for (char c : args) if (!isspace(static_cast<unsigned char>(c))) compact += c;
+      bool move = compact.size() > 2 && compact.compare(compact.size() - 2, 2, "&&") == 0 &&
+        compact.find(name) != std::string::npos;
+      if (name == sdef.name && !isStatic && !move) sdef.ctors.push_back(args);
+      return;
+    }
+    std::string rawRet = join(m, begin, open - 1);
+    if (is_unbindable_signature(rawRet, args) || rawRet == "auto") return;
+    std::string cleanRet = clean_type(m, begin, open - 1);
+    if (cleanRet.empty()) return;
+    sdef.methods.push_back({cleanRet, name, args, isConst, isStatic});
+  }
+
+  void parse_struct(const std::string& name, const Tokens& t, size_t open, size_t close,
+                    const std::vector<std::string>& guards)
+  {
+    StructDef sdef;
+    sdef.name = name;
+    sdef.guards = guards;
+    Tokens member;
+    int depth = 0;
+    bool isPublic = true;
+    auto finish = [&](bool isMethod)
+    {
+      if (isPublic && isMethod) parse_method(member, sdef);
+      else if (isPublic) parse_member(member, sdef);
+      member.clear();
+    };
+    for (size_t i = open + 1; i < close; ++i)
+    {
+      const Token& tok = t[i];
+      if (depth == 0 && member.empty() && (tok.is("public") || tok.is("private") || tok.is("protected")) &&
+        i + 1 < close && t[i + 1].is(":"))
+      {
+        isPublic = tok.is("public");
+        i++;
+        continue;
+      }
+      member.push_back(tok);
+      if (tok.is("{") || tok.is("(")) depth++;
+      else if (tok.is(")")) depth--;
+      else if (tok.is("}"))
+      {
+        // An inline method body ends the member without a `;`.
+        if (--depth == 0)
+        {
+          bool isMethod = false;
+          for (const auto& x : member) if (x.is("(")) isMethod = true;
+          if (isMethod && !(i + 1 < close && t[i + 1].is(";"))) finish(true);
+        }
+      }
+      else if (tok.is(";") && depth == 0)
+      {
+        member.pop_back();
+        bool isMethod = false;
+        for (const auto& x : member) if (x.is("(")) isMethod = true;
+        finish(isMethod);
+      }
+    }
+    model.structs.push_back(sdef);
+  }
+
+  static bool is_annotation_macro(std::string_view id)
+  {
+    if (id.size() > 1 && id[0] == '_' && (id[1] == '_' || isupper(static_cast<unsigned char>(id[1])))) return true;
+    for (char c : id)
+      if (!(isupper(static_cast<unsigned char>(c)) || isdigit(static_cast<unsigned char>(c)) || c == '_'))
+        return false;
+    return true;
+  }
+
+  void parse_function(const Tokens& t, const std::vector<std::string>& guards)
+  {
+    size_t open = t.size();
+    int angle = 0;
+    for (size_t i = 0; i < t.size(); ++i)
+    {
+      if (t[i].is("<")) angle++;
+      else if (t[i].is(">") && angle > 0) angle--;
+      else if (t[i].is("=") || t[i].is("{") || t[i].is(";")) return; // variable or aggregate
+      else if (t[i].is("(") && angle == 0)
+      {
+        open = i;
+        break;
+      }
+    }
+    if (open == t.size() || open < 2 || t[open - 1].kind != TokKind::Ident) return;
+    if (t[open - 2].is("::") || t[open - 2].is("~")) return; // out-of-line member / destructor
+    size_t close = match_close(t, open);
+    if (close >= t.size()) return;
+    size_t after = close + 1;
+    bool isNoexcept = false;
+    while (after < t.size() && (t[after].is("const") || t[after].is("noexcept") || t[after].is("override") ||
+      t[after].is("final")))
+      isNoexcept |= t[after++].is("noexcept");
+    if (after < t.size() && t[after].is("(") && t[after - 1].is("noexcept"))
+    {
+      size_t end = match_close(t, after);
+      isNoexcept = end == after + 2 && t[after + 1].is("true"); // noexcept(expr) counts only when literally true
+      after = end + 1;
+    }
+    // Trailing annotation macros such as `__THROW` or `API_DEPRECATED("...")`.
+    while (after < t.size() && t[after].kind == TokKind::Ident && is_annotation_macro(t[after].text))
+    {
+      after++;
+      if (after < t.size() && t[after].is("(")) after = match_close(t, after) + 1;
+    }
+    if (after >= t.size() || !(t[after].is(";") || t[after].is("{"))) return;
+
+    static const std::set<std::string> blacklist = {
+      "if", "while", "for", "switch", "return", "sizeof", "operator", "else"
+    };
+    std::string name(t[open - 1].text);
+    if (blacklist.count(name)) return;
+    if (name.compare(0, 2, "__") == 0 && is_annotation_macro(name) &&
+      std::none_of(name.begin(), name.end(), [](char c) { return islower(static_cast<unsigned char>(c)); }))
+      return; // macro-generated declaration, e.g. __REDIRECT(...)
+    for (size_t i = 0; i + 1 < open; ++i)
+      if (t[i].is("new") || t[i].is("delete") || t[i].is("return") || t[i].is("operator")) return;
+
+    std::string rawRet = join(t, 0, open - 1);
+    std::string rawArgs = join(t, open + 1, close);
+    if (is_unbindable_signature(rawRet, without_callback_params(rawArgs, callbackTypes))) return;
+    std::string cleanRet = clean_type(t, 0, open - 1);
+    if (cleanRet.empty()) return;
+    model.functions.push_back({cleanRet, name, rawArgs, guards, isNoexcept});
+  }
+
+  void analyze(const Tokens& raw, const std::vector<std::string>& guards)
+  {
+    Tokens t = strip_attributes(raw);
+    if (t.empty()) return;
+    if (t[0].is("template") || t[0].is("using") || t[0].is("namespace") || t[0].is("static_assert") ||
+      t[0].is("friend") || t[0].is("class") || t[0].is("union"))
+      return;
+
+    for (size_t i = 0; i < t.size(); ++i)
+    {
+      if (!t[i].is("typedef")) continue;
+      // typedef enum [Tag] { ... } Name;
+      size_t e = i + 1;
+      if (e < t.size() && t[e].is("enum"))
+      {
+        size_t open = e + 1;
+        while (open < t.size() && !t[open].is("{")) open++;
+        size_t close = open < t.size() ? match_close(t, open) : t.size();
+        if (close + 1 < t.size() && t[close + 1].kind == TokKind::Ident)
+          parse_enum(std::string(t[close + 1].text), t, open, close, guards);
+        return;
+      }
+      // typedef Ret (*Name)(Args);
+      for (size_t p = e; p + 4 < t.size(); ++p)
+      {
+        if (!(t[p].is("(") && t[p + 1].is("*") && t[p + 2].kind == TokKind::Ident && t[p + 3].is(")"))) continue;
+        size_t open = p + 4;
+        size_t close = t[open].is("(") ? match_close(t, open) : t.size();
+        std::string ret = clean_type(t, e, p);
+        if (close < t.size() && !ret.empty())
+        {
+          model.callbacks.push_back({std::string(t[p + 2].text), ret, join(t, open + 1, close), guards});
+          callbackTypes.insert(model.callbacks.back().name);
+        }
+        break;
+      }
+      return;
+    }
+
+    size_t i = 0;
+    if (t[i].is("struct") && t.size() > 2 && t[1].kind == TokKind::Ident && t[2].is("{"))
+    {
+      parse_struct(std::string(t[1].text), t, 2, match_close(t, 2), guards);
+      return;
+    }
+    if (t[i].is("struct") && t.size() > 2 && t[1].kind == TokKind::Ident && (t[2].is(":") || t[2].is("final")))
+      return; // derived structs are not bound
+    if (t[i].is("enum"))
+    {
+      i++;
+      if (i < t.size() && (t[i].is("class") || t[i].is("struct"))) i++;
+      if (i < t.size() && t[i].kind == TokKind::Ident)
+      {
+        std::string name(t[i].text);
+        size_t open = i + 1;
+        if (open < t.size() && t[open].is(":"))
+          while (open < t.size() && !t[open].is("{") && !t[open].is(";")) open++;
+        if (open < t.size() && t[open].is("{"))
+        {
+          parse_enum(name, t, open, match_close(t, open), guards);
+          return;
+        }
+      }
+      else if (i < t.size() && (t[i].is("{") || t[i].is(":")))
+        return; // anonymous enum
+    }
+    parse_function(t, guards);
+  }
+
+public:
+  explicit HeaderParser(std::string_view source) : lexer(source) {}
+
+  HeaderModel parse()
+  {
+    while (true)
+    {
+      Token t = take();
+      if (t.kind == TokKind::End) break;
+      if (t.is(";")) continue;
+      if (t.is("}"))
+      {
+        if (externDepth > 0) externDepth--;
+        continue;
+      }
+      // extern "C" { ... } is transparent; extern "C" on a single declaration is dropped.
+      if (t.is("extern") && peek().kind == TokKind::String)
+      {
+        take();
+        if (peek().is("{"))
+        {
+          take();
+          externDepth++;
+        }
+        continue;
+      }
+      Tokens decl;
+      std::vector<std::string> guards;
+      if (!collect(t, decl, guards)) break;
+      analyze(decl, guards);
+    }
+    return std::move(model);
+  }
+};
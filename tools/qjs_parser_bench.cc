@@ -0,0 +1,157 @@
+// Times the tokenizer-based HeaderParser against the legacy RegexHeaderParser on a
+// synthetic header.
+//
+// Usage: qjs_parser_bench [lines=100000] [--check] [--skip_legacy]
+//   --check        also compares the two models declaration by declaration
+//   --skip_legacy  only times the new parser (the regex parser is slow on large inputs)
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "qjs_header_parser.hpp"
+#include "qjs_regex_parser.hpp"
+
+namespace
+{
+  // Emits a block of representative declarations per iteration until `lines` is reached.
+  std::string make_header(size_t lines)
+  {
+    std::ostringstream out;
+    size_t n = 0;
+    out << "#ifndef BENCH_API_H\n#define BENCH_API_H\n\n#include <string>\n#include <cstdint>\n\n";
+    out << "#ifdef __cplusplus\nextern \"C\" {\n#endif\n";
+    n += 10;
+    for (size_t i = 0; n < lines; ++i)
+    {
+      out << "\n// ---- block " << i << " ----\n";
+      out << "#define BENCH_LIMIT_" << i << " " << i * 3 << "\n";
+      out << "#define BENCH_NAME_" << i << " \"bench_" << i << "\"\n";
+      out << "#define BENCH_MAX_" << i << "(a, b) ((a) > (b) ? (a) : (b))\n";
+      out << "\n/* Flags for block " << i << ".\n * Multi-line comment. */\n";
+      out << "enum BenchFlags" << i << " {\n  BF" << i << "_NONE = 0,\n  BF" << i << "_READ = 1 << 0,\n  BF" << i <<
+        "_WRITE = 1 << 1,\n  BF" << i << "_ALL = BF" << i << "_READ | BF" << i << "_WRITE\n};\n";
+      out << "typedef enum {\n  MODE" << i << "_A,\n  MODE" << i << "_B = 5,\n  MODE" << i << "_C\n} BenchMode" << i <<
+        ";\n";
+      out << "struct BenchRecord" << i << " {\n  int id;\n  double score; // running average\n  bool active;\n"
+        "  std::string label;\n  unsigned int flags : 4;\n};\n";
+      out << "#if BENCH_FEATURE_" << i % 4 << "\n";
+      out << "int bench_compute_" << i << "(int a, int b);\n";
+      out << "double bench_scale_" << i << "(double value,\n                      double factor);\n";
+      out << "#else\n";
+      out << "void bench_reset_" << i << "(void);\n";
+      out << "#endif\n";
+      out << "const char* bench_name_" << i << "(int index);\n";
+      out << "void bench_update_" << i << "(struct BenchRecord" << i << "* rec, int delta);\n";
+      out << "typedef void (*bench_cb_t" << i << ")(int);\n";
+      out << "void bench_on_event_" << i << "(bench_cb_t" << i << " cb);\n";
+      out << "static inline int bench_twice_" << i << "(int v) {\n  if (v > 0) {\n    return v * 2;\n  }\n"
+        "  return 0;\n}\n";
+      n += 43;
+    }
+    out << "\n#ifdef __cplusplus\n}\n#endif\n\n#endif\n";
+    return out.str();
+  }
+
+  template <typename F>
+  double time_ms(F&& f)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  void report(const char* name, double ms, size_t lines, const HeaderModel& m)
+  {
+    std::cout << name << ": " << ms << " ms, " << static_cast<size_t>(lines / (ms / 1000.0)) << " lines/s ("
+      << m.functions.size() << " functions, " << m.enums.size() << " enums, " << m.structs.size() << " structs, "
+      << m.macros.size() << " macros)\n";
+  }
+
+  std::string join(const std::vector<std::string>& v)
+  {
+    std::string s;
+    for (const auto& x : v) s += x + "\n";
+    return s;
+  }
+
+  // Returns the number of mismatching declarations.
+  size_t compare(const HeaderModel& a, const HeaderModel& b)
+  {
+    size_t bad = 0;
+    auto check = [&](bool same, const std::string& what)
+    {
+      if (!same && bad++ < 10) std::cerr << "mismatch: " << what << "\n";
+    };
+    check(a.functions.size() == b.functions.size(), "function count");
+    for (size_t i = 0; i < std::min(a.functions.size(), b.functions.size()); ++i)
+    {
+      const auto& x = a.functions[i];
+      const auto& y = b.functions[i];
+      check(x.name == y.name && x.retType == y.retType && x.args == y.args && join(x.guards) == join(y.guards),
+            "function " + x.name + " / " + y.name);
+    }
+    check(a.enums.size() == b.enums.size(), "enum count");
+    for (size_t i = 0; i < std::min(a.enums.size(), b.enums.size()); ++i)
+      check(a.enums[i].name == b.enums[i].name && a.enums[i].members == b.enums[i].members &&
+            join(a.enums[i].guards) == join(b.enums[i].guards), "enum " + a.enums[i].name);
+    check(a.structs.size() == b.structs.size(), "struct count");
+    for (size_t i = 0; i < std::min(a.structs.size(), b.structs.size()); ++i)
+    {
+      bool same = a.structs[i].name == b.structs[i].name && a.structs[i].fields.size() == b.structs[i].fields.size();
+      for (size_t f = 0; same && f < a.structs[i].fields.size(); ++f)
+        same = a.structs[i].fields[f].name == b.structs[i].fields[f].name &&
+          a.structs[i].fields[f].type == b.structs[i].fields[f].type;
+      check(same, "struct " + a.structs[i].name);
+    }
+    check(a.callbacks.size() == b.callbacks.size(), "callback count");
+    for (size_t i = 0; i < std::min(a.callbacks.size(), b.callbacks.size()); ++i)
+      check(a.callbacks[i].name == b.callbacks[i].name && a.callbacks[i].retType == b.callbacks[i].retType &&
+            a.callbacks[i].args == b.callbacks[i].args && join(a.callbacks[i].guards) == join(b.callbacks[i].guards),
+            "callback " + a.callbacks[i].name);
+    check(a.macros.size() == b.macros.size(), "macro count");
+    for (size_t i = 0; i < std::min(a.macros.size(), b.macros.size()); ++i)
+      check(a.macros[i].name == b.macros[i].name && a.macros[i].value == b.macros[i].value,
+            "macro " + a.macros[i].name);
+    return bad;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  size_t lines = 100000;
+  bool checkModels = false, skipLegacy = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--check") checkModels = true;
+    else if (arg == "--skip_legacy") skipLegacy = true;
+    else lines = std::strtoul(arg.c_str(), nullptr, 10);
+  }
+
+  std::string source = make_header(lines);
+  std::cout << "synthetic header: " << lines << " lines, " << source.size() << " bytes\n";
+
+  HeaderModel fresh;
+  double freshMs = time_ms([&] { fresh = HeaderParser(source).parse(); });
+  report("tokenizer", freshMs, lines, fresh);
+
+  if (skipLegacy) return 0;
+  HeaderModel legacy;
+  double legacyMs = time_ms([&]
+  {
+    std::istringstream in(source);
+    legacy = RegexHeaderParser().parse(in);
+  });
+  report("regex    ", legacyMs, lines, legacy);
+  std::cout << "speedup: " << legacyMs / freshMs << "x\n";
+
+  if (checkModels)
+  {
+    size_t bad = compare(legacy, fresh);
+    std::cout << (bad ? "models differ: " + std::to_string(bad) + " mismatches" : std::string("models match")) << "\n";
+    return bad ? 1 : 0;
+  }
+  return 0;
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+// The original line-buffered regex parser, kept only as the baseline for qjs_parser_bench.
+// It does not see constructors, member functions or static methods, so the generator always
+// uses qjs_header_parser.hpp; new parsing work goes there.
+
+#include <istream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <boost/regex.hpp>
+#include <boost/algorithm/string.hpp>
+#include "qjs_header_parser.hpp"
+
+class RegexHeaderParser
+{
+  HeaderModel model;
+  std::set<std::string> callbackTypes; // names in model.callbacks, for the signature filter
+
+  std::string clean_type_string(std::string raw)
+  {
+    boost::regex re_space(R"([\r\n\t]+)");
+    std::string s = boost::regex_replace(raw, re_space, " ");
+    boost::regex re_keywords(R"(\b(inline|static|constexpr|extern|virtual|explicit)\b)");
+    s = boost::regex_replace(s, re_keywords, "");
+    boost::regex re_multi_space(R"(\s+)");
+    s = boost::regex_replace(s, re_multi_space, " ");
+    return boost::regex_replace(s, boost::regex(R"(^\s+|\s+$)"), "");
+  }
+
+  std::string clean_args_string(std::string raw)
+  {
+    boost::regex re_space(R"([\r\n\t]+)");
+    return boost::regex_replace(raw, re_space, " ");
+  }
+
+
+  std::vector<std::string> get_active_guards(const std::vector<GuardState>& stack)
+  {
+    std::vector<std::string> active;
+    for (const auto& g : stack) if (!g.isHeaderGuard) active.push_back(g.line);
+    return active;
+  }
+
+  std::string invert_guard(const std::string& line)
+  {
+    boost::regex re_ifdef(R"(^\s*#ifdef\s+(.*))");
+    boost::smatch m;
+    if (boost::regex_match(line, m, re_ifdef)) return "#ifndef " + m[1].str();
+    boost::regex re_ifndef(R"(^\s*#ifndef\s+(.*))");
+    if (boost::regex_match(line, m, re_ifndef)) return "#ifdef " + m[1].str();
+    boost::regex re_if(R"(^\s*#if\s+(.*))");
+    if (boost::regex_match(line, m, re_if))
+    {
+      std::string cond = m[1].str();
+      boost::trim(cond);
+      return "#if !(" + cond + ")";
+    }
+    return line;
+  }
+
+
+  void process_enum(std::string name, std::string body, const std::vector<std::string>& guards)
+  {
+    boost::regex re_complex_macro(R"(\b[A-Z_][A-Z0-9_]*\s*\()");
+    if (boost::regex_search(body, re_complex_macro)) return;
+    EnumDef edef;
+    edef.name = name;
+    edef.guards = guards;
+    std::map<std::string, int> symbol_table;
+    boost::regex re_member(R"(([a-zA-Z0-9_]+)\s*(?:=\s*([^,]+))?)");
+    boost::smatch m;
+    int currentVal = 0;
+    auto start = body.cbegin();
+    while (boost::regex_search(start, body.cend(), m, re_member))
+    {
+      std::string key = m[1];
+      std::string val_str = "";
+      if (m.size() > 2 && m[2].matched)
+      {
+        val_str = m[2];
+        size_t cpos = val_str.find("//");
+        if (cpos != std::string::npos) val_str = val_str.substr(0, cpos);
+        cpos = val_str.find("/*");
+        if (cpos != std::string::npos) val_str = val_str.substr(0, cpos);
+        boost::trim(val_str);
+      }
+      if (isdigit(key[0]) || key == "public" || key == "private")
+      {
+        start = m.suffix().first;
+        continue;
+      }
+      int val = currentVal;
+      if (!val_str.empty())
+      {
+        val = evaluate_expression(val_str, symbol_table);
+        currentVal = val;
+      }
+      symbol_table[key] = val;
+      edef.members.push_back({key, val_str.empty() ? std::to_string(val) : val_str});
+      currentVal++;
+      start = m.suffix().first;
+    }
+    if (!edef.members.empty()) model.enums.push_back(edef);
+  }
+
+  void process_struct(std::string name, std::string body, const std::vector<std::string>& guards)
+  {
+    StructDef sdef;
+    sdef.name = name;
+    sdef.guards = guards;
+    // Commas only inside template arguments (std::map<K, V>, std::array<T, N>)
+    boost::regex re_field(R"(((?:[a-zA-Z0-9_:\*&\s]|<[^;{}]*>)+?)\s+(\w+)\s*(:\s*\d+)?\s*;\s*)");
+    auto start = body.cbegin();
+    boost::smatch m;
+    while (boost::regex_search(start, body.cend(), m, re_field))
+    {
+      std::string type = clean_type_string(m[1]);
+      std::string fname = m[2];
+      if (isdigit(fname[0]))
+      {
+        start = m.suffix().first;
+        continue;
+      }
+
+      bool is_func_ptr = (type.find("(") != std::string::npos);
+      bool is_typedef = (type.find("typedef") != std::string::npos);
+      bool is_callback = (type.length() >= 5 && type.substr(type.length() - 5) == "_cb_t") || (type.length() >= 7 &&
+        type.substr(type.length() - 7) == "_walker");
+
+      if (!is_func_ptr && !is_typedef && !is_callback)
+      {
+        boost::trim(type);
+        sdef.fields.push_back({type, fname, m[3].matched});
+      }
+      start = m.suffix().first;
+    }
+    model.structs.push_back(sdef);
+  }
+
+public:
+  HeaderModel parse(std::istream& file)
+  {
+    model = HeaderModel();
+    callbackTypes.clear();
+    std::string line;
+    std::vector<GuardState> guardStack;
+    std::string buffer;
+    int brace_depth = 0;
+
+    boost::regex re_macro_val(R"(^\s*#define\s+([A-Z0-9_]+)\s+(\".*\"|-?\d+(\.\d+)?))");
+    boost::regex re_define_simple(R"(^\s*#define\s+([A-Z0-9_]+))");
+    boost::regex re_ifndef(R"(^\s*#ifndef\s+([A-Z0-9_]+))");
+    boost::regex re_elif(R"(^\s*#elif\s+(.*))");
+    boost::regex re_enum_cpp(R"(enum\s+(class\s+)?(\w+)\s*\{([\s\S]*?)\};)");
+    boost::regex re_enum_c(R"(typedef\s+enum\s*\{([\s\S]*?)\}\s*(\w+);)");
+    boost::regex re_struct(R"(struct\s+(\w+)\s*\{([\s\S]*?)\};)");
+    boost::regex re_callback(R"(typedef\s+([\s\S]+?)\(\s*\*\s*(\w+)\s*\)\s*\(([\s\S]*?)\)\s*;)");
+    boost::regex re_func(R"(((?:[a-zA-Z0-9_:\*&\s]|<[^;{}()]*>)+?)\s+(\w+)\s*\(([\s\S]*?)\)\s*(?:;|{))");
+    std::set<std::string> blacklist = {"if", "while", "for", "switch", "return", "sizeof", "operator", "else"};
+    bool in_comment_block = false;
+
+    while (std::getline(file, line))
+    {
+      std::string trimmed = line;
+      boost::trim(trimmed);
+      if (in_comment_block)
+      {
+        if (trimmed.find("*/") != std::string::npos) in_comment_block = false;
+        continue;
+      }
+      if (trimmed.find("/*") != std::string::npos)
+      {
+        if (trimmed.find("*/") == std::string::npos) in_comment_block = true;
+        trimmed = trimmed.substr(0, trimmed.find("/*"));
+      }
+      if (trimmed.find("//") != std::string::npos) trimmed = trimmed.substr(0, trimmed.find("//"));
+      boost::trim(trimmed);
+      if (trimmed.empty()) continue;
+
+      if (trimmed[0] == '#')
+      {
+        boost::smatch m;
+        if (boost::starts_with(trimmed, "#define"))
+        {
+          if (boost::regex_search(trimmed, m, re_define_simple))
+          {
+            std::string defSym = m[1];
+            if (!guardStack.empty() && guardStack.back().symbol == defSym)
+            {
+              guardStack.back().isHeaderGuard = true;
+              continue;
+            }
+          }
+          if (boost::regex_search(trimmed, m, re_macro_val))
+            model.macros.push_back({
+              m[1], m[2], get_active_guards(guardStack)
+            });
+        }
+        else if (boost::starts_with(trimmed, "#if"))
+        {
+          GuardState gs;
+          gs.line = trimmed;
+          gs.isHeaderGuard = false;
+          if (boost::starts_with(trimmed, "#ifndef") && boost::regex_search(trimmed, m, re_ifndef)) gs.symbol = m[1];
+          guardStack.push_back(gs);
+        }
+        else if (boost::starts_with(trimmed, "#endif")) { if (!guardStack.empty()) guardStack.pop_back(); }
+        else if (boost::starts_with(trimmed, "#else"))
+        {
+          if (!guardStack.empty())
+          {
+            std::string prev = guardStack.back().line;
+            guardStack.pop_back();
+            guardStack.push_back({invert_guard(prev), "", false});
+          }
+        }
+        else if (boost::starts_with(trimmed, "#elif"))
+        {
+          if (!guardStack.empty())
+          {
+            guardStack.pop_back();
+            if (boost::regex_search(trimmed, m, re_elif)) guardStack.push_back({"#if " + m[1].str(), "", false});
+          }
+        }
+        continue;
+      }
+
+      bool is_extern_c = (line.find("extern \"C\"") != std::string::npos);
+      for (char c : trimmed)
+      {
+        if (c == '{') { if (!is_extern_c) brace_depth++; }
+        else if (c == '}') { if (brace_depth > 0) brace_depth--; }
+      }
+      buffer += trimmed + "\n";
+
+      if (brace_depth == 0 && (trimmed.back() == ';' || trimmed.back() == '}'))
+      {
+        boost::smatch m;
+        if (buffer.find("typedef") != std::string::npos && buffer.find("enum") == std::string::npos)
+        {
+          // Callback typedefs are recorded, as in HeaderParser; other typedefs are ignored
+          if (boost::regex_search(buffer, m, re_callback))
+          {
+            std::string ret = clean_type_string(m[1]);
+            if (!ret.empty())
+            {
+              model.callbacks.push_back({m[2], ret, clean_args_string(m[3]), get_active_guards(guardStack)});
+              callbackTypes.insert(m[2]);
+            }
+          }
+          buffer.clear();
+          continue;
+        }
+        if (boost::regex_search(buffer, m, re_struct))
+        {
+          process_struct(m[1], m[2], get_active_guards(guardStack));
+          buffer.clear();
+          continue;
+        }
+        if (boost::regex_search(buffer, m, re_enum_cpp))
+        {
+          process_enum(m[2], m[3], get_active_guards(guardStack));
+          buffer.clear();
+          continue;
+        }
+        if (boost::regex_search(buffer, m, re_enum_c))
+        {
+          process_enum(m[2], m[1], get_active_guards(guardStack));
+          buffer.clear();
+          continue;
+        }
+        if (boost::regex_search(buffer, m, re_func))
+        {
+          std::string rawRet = m[1];
+          std::string name = m[2];
+          std::string rawArgs = m[3];
+          bool skip = false;
+          if (rawRet.find('=') != std::string::npos || rawRet.find("new") != std::string::npos ||
+            rawRet.find("return") != std::string::npos || rawRet.find("delete") != std::string::npos)
+            skip = true;
+          // Same naming heuristics as HeaderParser, callback parameters excepted
+          if (is_unbindable_signature(rawRet, without_callback_params(rawArgs, callbackTypes))) skip = true;
+          if (blacklist.count(name)) skip = true;
+          if (!skip)
+          {
+            std::string cleanRet = clean_type_string(rawRet);
+            if (!cleanRet.empty())
+            {
+              model.functions.push_back({cleanRet, name, clean_args_string(rawArgs), get_active_guards(guardStack), false});
+              buffer.clear();
+              continue;
+            }
+          }
+        }
+        buffer.clear();
+      }
+    }
+    return std::move(model);
+  }
+};
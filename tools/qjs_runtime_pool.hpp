@@ -0,0 +1,265 @@
+#pragma once
+
+#include "qjs_utils.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// --- Runtime / Context Pool ---
+// A QuickJS runtime is single-threaded, but any thread may drive it while no other thread
+// does. QJSRuntimePool keeps N runtimes, each with one context that has the configured
+// modules registered, and leases them to worker threads: acquire() blocks until an engine
+// is free, the Lease hands it back when it goes out of scope.
+//
+//   QJSRuntimePool pool(QJSRuntimePool::Options{}.with_runtimes(8));
+//   pool.add_module<struct MyApiTag>("my_api", js_init_module_my_api);
+//   pool.start();
+//   ...
+//   auto lease = pool.acquire();           // on a worker thread
+//   JS_Eval(lease.ctx(), ...);
+//
+// Modules are attached through module templates (see section 8 of qjs_utils.hpp): the
+// generated init runs once per runtime, and a recycled context only re-exports the cached
+// values. Runtimes are initialised in parallel; class IDs are process-wide (qjs_class_id),
+// so they agree across all runtimes of the pool.
+class QJSRuntimePool {
+public:
+    struct Options {
+        size_t runtimes = std::max(1u, std::thread::hardware_concurrency());
+        size_t recycle_after = 0; // leases before a context is replaced by a fresh one (0 = never)
+        size_t memory_limit = 0;  // JS_SetMemoryLimit per runtime in bytes (0 = none)
+        size_t stack_size = 0;    // JS_SetMaxStackSize per runtime in bytes (0 = QuickJS default)
+
+        Options& with_runtimes(size_t n) { runtimes = std::max<size_t>(n, 1); return *this; }
+        Options& with_recycle_after(size_t n) { recycle_after = n; return *this; }
+        Options& with_memory_limit(size_t bytes) { memory_limit = bytes; return *this; }
+        Options& with_stack_size(size_t bytes) { stack_size = bytes; return *this; }
+    };
+
+    // Runs in every fresh context after the modules are registered (imports, globals, ...).
+    // Returning false fails start() or, on recycling, drops the engine from the pool.
+    using ContextSetup = std::function<bool(JSContext*)>;
+
+    struct Stats {
+        uint64_t leases = 0;   // acquire() calls served
+        uint64_t waits = 0;    // of which had to wait for a free engine
+        uint64_t recycled = 0; // contexts replaced after recycle_after leases
+    };
+
+private:
+    struct Engine {
+        JSRuntime* rt = nullptr;
+        JSContext* ctx = nullptr;
+        size_t uses = 0;
+    };
+
+    struct Module {
+        std::string name;
+        JSModuleDef* (*attach)(JSContext*, const char*, QJSModuleInit);
+        void (*release)(JSRuntime*);
+        QJSModuleInit init;
+    };
+
+public:
+    // Exclusive use of one engine. Movable, returns the engine to the pool on destruction.
+    class Lease {
+        QJSRuntimePool* pool_ = nullptr;
+        Engine* engine_ = nullptr;
+
+        friend class QJSRuntimePool;
+        Lease(QJSRuntimePool* pool, Engine* engine) : pool_(pool), engine_(engine) {}
+
+    public:
+        Lease() = default;
+        Lease(Lease&& o) noexcept : pool_(std::exchange(o.pool_, nullptr)), engine_(std::exchange(o.engine_, nullptr)) {}
+        Lease& operator=(Lease&& o) noexcept {
+            if (this != &o) {
+                release();
+                pool_ = std::exchange(o.pool_, nullptr);
+                engine_ = std::exchange(o.engine_, nullptr);
+            }
+            return *this;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        explicit operator bool() const { return engine_ != nullptr; }
+        JSContext* ctx() const { return engine_ ? engine_->ctx : nullptr; }
+        JSRuntime* runtime() const { return engine_ ? engine_->rt : nullptr; }
+
+        void release() {
+            if (engine_) pool_->give_back(engine_);
+            pool_ = nullptr;
+            engine_ = nullptr;
+        }
+    };
+
+    QJSRuntimePool() : QJSRuntimePool(Options()) {}
+    explicit QJSRuntimePool(Options options) : options_(options) {}
+    QJSRuntimePool(const QJSRuntimePool&) = delete;
+    QJSRuntimePool& operator=(const QJSRuntimePool&) = delete;
+
+    // Leases must be gone by now
+    ~QJSRuntimePool() {
+        for (auto& e : engines_) destroy(*e);
+    }
+
+    // Registers generated module `name` in every context. `Tag` names its template slot, one
+    // distinct type per module (as for qjs_attach_module_template). Call before start().
+    template<typename Tag>
+    QJSRuntimePool& add_module(const char* name, QJSModuleInit init) {
+        modules_.push_back({name, &qjs_attach_module_template<Tag>, &qjs_release_module_template<Tag>, init});
+        return *this;
+    }
+
+    QJSRuntimePool& on_context(ContextSetup setup) {
+        setup_ = std::move(setup);
+        return *this;
+    }
+
+    // Creates and initialises the runtimes, one thread each. False if any of them failed;
+    // the pool is then empty.
+    bool start() {
+        std::vector<std::unique_ptr<Engine>> engines(options_.runtimes);
+        std::vector<char> ok(engines.size(), 0);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < engines.size(); ++i) {
+            engines[i].reset(new Engine());
+            threads.emplace_back([this, &engines, &ok, i] { ok[i] = init_engine(*engines[i]); });
+        }
+        for (auto& t : threads) t.join();
+        bool all = std::all_of(ok.begin(), ok.end(), [](char v) { return v != 0; });
+        if (!all) {
+            for (auto& e : engines) destroy(*e);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mu_);
+        for (auto& e : engines) {
+            idle_.push_back(e.get());
+            engines_.push_back(std::move(e));
+        }
+        cv_.notify_all();
+        return true;
+    }
+
+    // Blocks until an engine is free. An empty Lease if the pool has no engines at all.
+    Lease acquire() {
+        std::unique_lock<std::mutex> lock(mu_);
+        bool waited = idle_.empty() && !engines_.empty();
+        cv_.wait(lock, [this] { return !idle_.empty() || engines_.empty(); });
+        if (idle_.empty()) return {};
+        stats_.leases++;
+        if (waited) stats_.waits++;
+        // LIFO: the most recently used engine has the warmest caches
+        Engine* e = idle_.back();
+        idle_.pop_back();
+        lock.unlock();
+        // The runtime's stack limit is measured from the thread that last set it
+        JS_UpdateStackTop(e->rt);
+        return Lease(this, e);
+    }
+
+    // Like acquire(), but returns an empty Lease instead of waiting.
+    Lease try_acquire() {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (idle_.empty()) return {};
+        stats_.leases++;
+        Engine* e = idle_.back();
+        idle_.pop_back();
+        JS_UpdateStackTop(e->rt);
+        return Lease(this, e);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return engines_.size();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return stats_;
+    }
+
+private:
+    Options options_;
+    std::vector<Module> modules_;
+    ContextSetup setup_;
+
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Engine>> engines_;
+    std::vector<Engine*> idle_;
+    Stats stats_;
+
+    bool init_context(Engine& e) {
+        e.ctx = JS_NewContext(e.rt);
+        if (!e.ctx) return false;
+        e.uses = 0;
+        for (const auto& m : modules_)
+            if (!m.attach(e.ctx, m.name.c_str(), m.init)) return false;
+        return !setup_ || setup_(e.ctx);
+    }
+
+    bool init_engine(Engine& e) {
+        e.rt = JS_NewRuntime();
+        if (!e.rt) return false;
+        if (options_.memory_limit) JS_SetMemoryLimit(e.rt, options_.memory_limit);
+        if (options_.stack_size) JS_SetMaxStackSize(e.rt, options_.stack_size);
+        return init_context(e);
+    }
+
+    void destroy(Engine& e) {
+        // Same order as a host tearing down by hand: callbacks the scripts registered hold the
+        // context, in-flight async calls hold JS values
+        if (e.ctx) qjs_callbacks_release(e.ctx);
+        if (e.rt) qjs_async_release(e.rt);
+        if (e.ctx) JS_FreeContext(e.ctx);
+        e.ctx = nullptr;
+        if (!e.rt) return;
+        // Module templates hold a private context that must go before the runtime
+        for (const auto& m : modules_) m.release(e.rt);
+        JS_FreeRuntime(e.rt);
+        e.rt = nullptr;
+    }
+
+    // Runs what the lease left queued, then recycles the context if it is due.
+    void give_back(Engine* e) {
+        JSContext* job_ctx = nullptr;
+        for (int r; (r = JS_ExecutePendingJob(e->rt, &job_ctx)) != 0;) {
+            if (r < 0) JS_FreeValue(job_ctx, JS_GetException(job_ctx)); // nobody is left to report it to
+        }
+        bool recycled = false, alive = true;
+        if (options_.recycle_after && ++e->uses >= options_.recycle_after) {
+            qjs_callbacks_release(e->ctx); // registered callbacks would keep the old context alive
+            JS_FreeContext(e->ctx);
+            e->ctx = nullptr;
+            JS_RunGC(e->rt);
+            alive = init_context(*e);
+            recycled = true;
+        }
+        std::unique_ptr<Engine> dead;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (recycled) stats_.recycled++;
+            if (alive) {
+                idle_.push_back(e);
+                cv_.notify_one();
+                return;
+            }
+            auto it = std::find_if(engines_.begin(), engines_.end(),
+                                   [e](const std::unique_ptr<Engine>& p) { return p.get() == e; });
+            dead = std::move(*it);
+            engines_.erase(it);
+        }
+        // Teardown waits for in-flight async calls: keep it out of the lock, as start() does
+        destroy(*dead);
+        cv_.notify_all(); // waiters give up once the last engine is gone
+    }
+};
@@ -0,0 +1,72 @@
+// Measures string marshalling through Wrapper<Func>::call for 16 B, 1 KB and 1 MB strings:
+// `const std::string&` parameters (one copy), `std::string_view` parameters (borrowed from
+// JS_ToCStringLen for the call) and `const std::string&` results (JS_NewStringLen).
+// Arguments are pre-built, so only conversion cost is measured.
+//
+// Usage: qjs_string_bench [bytes_per_case=268435456]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include "qjs_utils.hpp"
+
+namespace
+{
+  std::string payload;
+
+  size_t bench_len_string(const std::string& s) { return s.size(); }
+  size_t bench_len_view(std::string_view s) { return s.size(); }
+  const std::string& bench_get_string() { return payload; }
+
+  volatile int64_t sink = 0;
+
+  // ns per call
+  template <auto Func>
+  double ns_per_call(JSContext* ctx, JSValueConst* argv, int argc, int64_t iterations)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      JSValue r = Wrapper<Func>::call(ctx, JS_UNDEFINED, argc, argv);
+      sink += JS_VALUE_GET_TAG(r);
+      JS_FreeValue(ctx, r);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return secs * 1e9 / iterations;
+  }
+
+  void report(const char* label, size_t size, double ns)
+  {
+    double mbps = ns > 0 ? size / ns * 1e9 / (1 << 20) : 0;
+    std::printf("  %-24s %12.1f ns/call %10.0f MB/s\n", label, ns, mbps);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int64_t budget = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : int64_t(256) << 20;
+
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+  for (size_t size : {size_t(16), size_t(1024), size_t(1) << 20})
+  {
+    int64_t iterations = std::clamp<int64_t>(budget / static_cast<int64_t>(size), 100, 10000000);
+    payload.assign(size, 'x');
+    JSValue arg = JS_NewStringLen(ctx, payload.data(), payload.size());
+
+    std::printf("%zu bytes, %lld iterations\n", size, static_cast<long long>(iterations));
+    report("param const std::string&", size, ns_per_call<bench_len_string>(ctx, &arg, 1, iterations));
+    report("param std::string_view", size, ns_per_call<bench_len_view>(ctx, &arg, 1, iterations));
+    report("return std::string", size, ns_per_call<bench_get_string>(ctx, nullptr, 0, iterations));
+
+    JS_FreeValue(ctx, arg);
+  }
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+  return 0;
+}
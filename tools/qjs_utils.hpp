@@ -2,21 +2,345 @@
 
 #include "quickjs.h"
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
+#include <map>
+#include <optional>
 #include <type_traits>
 #include <utility>
+#include <tuple>
 #include <iostream>
 #include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <cassert>
+#include <new>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define QJS_HAS_SPAN 1
+#endif
 
 // Debug Macro
 // #define QJS_DEBUG_BINDING
 
 #ifdef QJS_DEBUG_BINDING
     #define QJS_LOG(msg) std::cerr << "[QJS_BIND] " << msg << std::endl
+    #ifndef QJS_PROFILE_BINDING
+        #define QJS_PROFILE_BINDING
+    #endif
 #else
     #define QJS_LOG(msg)
 #endif
 
+// Exception-free mode
+// #define QJS_NO_EXCEPTIONS (implied when compiled with -fno-exceptions)
+//
+// Bound calls validate each argument before converting it and report a mismatch as a JS
+// TypeError ("arg 2 of update_user_score: expected User") instead of coercing it; generated
+// setters and assign() check fields the same way. No try/catch is compiled in, so bound
+// functions must not throw. A JS exception raised by a callback stays pending and the
+// bound call returns JS_EXCEPTION once the native function returns. Generated modules also
+// use Boost.JSON, which under -fno-exceptions needs the application to define
+// boost::throw_exception.
+#if !defined(QJS_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS) && !defined(_CPPUNWIND)
+#define QJS_NO_EXCEPTIONS
+#endif
+
+// Binding Profiler
+// #define QJS_PROFILE_BINDING (implied by QJS_DEBUG_BINDING)
+//
+// Wrapper<Func>::call and the generated accessors record, per binding: call count,
+// argument conversion, native execution and return conversion time. Counters are
+// per thread (no locks, no shared cache lines on the hot path) and summed when read.
+// Timestamps come from rdtsc on x86 and steady_clock elsewhere. Read the table with
+// QJSProfiler::json() / dump() from C++, or __bindingStats() from JS.
+
+#ifdef QJS_PROFILE_BINDING
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <chrono>
+#include <ostream>
+#include <sstream>
+
+struct QJSProfileCounters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> args{0};   // ticks spent converting arguments
+    std::atomic<uint64_t> native{0}; // ticks spent in the bound C++ code
+    std::atomic<uint64_t> ret{0};    // ticks spent converting the result
+
+    // Single writer (the owning thread): relaxed load + store, no locked RMW.
+    static void bump(std::atomic<uint64_t>& c, uint64_t v) {
+        c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+};
+
+class QJSProfiler {
+public:
+    using Phase = std::atomic<uint64_t> QJSProfileCounters::*;
+
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Returns the index of binding `name`, registering it on first use.
+    static uint32_t site(const std::string& name) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        for (uint32_t i = 0; i < r.names.size(); ++i) {
+            if (r.names[i] == name) return i;
+        }
+        r.names.push_back(name);
+        return static_cast<uint32_t>(r.names.size() - 1);
+    }
+
+    // This thread's counters for `site`.
+    static QJSProfileCounters& local(uint32_t site) {
+        thread_local ThreadBlock block;
+        size_t chunk = site / kChunk;
+        if (chunk >= block.chunks.size()) block.grow(chunk + 1);
+        return block.chunks[chunk][site % kChunk];
+    }
+
+    struct Row {
+        std::string name;
+        uint64_t calls = 0;
+        double args_ns = 0, native_ns = 0, ret_ns = 0;
+    };
+
+    // Sums every thread's counters (live and exited threads) per binding.
+    static std::vector<Row> snapshot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        double ns = ns_per_tick(r);
+        std::vector<Row> rows(r.names.size());
+        for (size_t i = 0; i < rows.size(); ++i) rows[i].name = r.names[i];
+        auto add = [&](size_t i, const QJSProfileCounters& c) {
+            rows[i].calls += c.calls.load(std::memory_order_relaxed);
+            rows[i].args_ns += c.args.load(std::memory_order_relaxed) * ns;
+            rows[i].native_ns += c.native.load(std::memory_order_relaxed) * ns;
+            rows[i].ret_ns += c.ret.load(std::memory_order_relaxed) * ns;
+        };
+        for (size_t i = 0; i < rows.size() && i < r.retired.size(); ++i) add(i, r.retired[i]);
+        for (ThreadBlock* b : r.threads) {
+            for (size_t i = 0; i < rows.size() && i / kChunk < b->chunks.size(); ++i)
+                add(i, b->chunks[i / kChunk][i % kChunk]);
+        }
+        return rows;
+    }
+
+    // Zeroes all counters; names stay registered.
+    static void reset() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        auto zero = [](QJSProfileCounters& c) {
+            c.calls.store(0, std::memory_order_relaxed);
+            c.args.store(0, std::memory_order_relaxed);
+            c.native.store(0, std::memory_order_relaxed);
+            c.ret.store(0, std::memory_order_relaxed);
+        };
+        for (auto& c : r.retired) zero(c);
+        for (ThreadBlock* b : r.threads) {
+            for (auto& chunk : b->chunks) {
+                for (size_t i = 0; i < kChunk; ++i) zero(chunk[i]);
+            }
+        }
+    }
+
+    // [{"name":..,"calls":..,"args_ns":..,"native_ns":..,"return_ns":..,"total_ns":..}, ...]
+    // sorted by total time, bindings that were never called are left out.
+    static std::string json() {
+        std::vector<Row> rows = snapshot();
+        rows.erase(std::remove_if(rows.begin(), rows.end(), [](const Row& row) { return row.calls == 0; }), rows.end());
+        std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+            return a.args_ns + a.native_ns + a.ret_ns > b.args_ns + b.native_ns + b.ret_ns;
+        });
+        std::ostringstream out;
+        out << "[";
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Row& row = rows[i];
+            out << (i ? ",\n " : "") << "{\"name\":\"";
+            for (char c : row.name) {
+                if (c == '"' || c == '\\') out << '\\';
+                out << c;
+            }
+            out << "\",\"calls\":" << row.calls << ",\"args_ns\":" << static_cast<uint64_t>(row.args_ns)
+                << ",\"native_ns\":" << static_cast<uint64_t>(row.native_ns)
+                << ",\"return_ns\":" << static_cast<uint64_t>(row.ret_ns)
+                << ",\"total_ns\":" << static_cast<uint64_t>(row.args_ns + row.native_ns + row.ret_ns) << "}";
+        }
+        out << "]";
+        return out.str();
+    }
+
+    static void dump(std::ostream& os) { os << json() << std::endl; }
+
+private:
+    static constexpr size_t kChunk = 64;
+
+    struct ThreadBlock;
+    struct Registry {
+        std::mutex mu;
+        std::vector<std::string> names;
+        std::vector<ThreadBlock*> threads;
+        std::vector<QJSProfileCounters> retired; // totals of threads that have exited
+        uint64_t tick0 = now();
+        std::chrono::steady_clock::time_point time0 = std::chrono::steady_clock::now();
+    };
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    // Nanoseconds per tick, calibrated against steady_clock since the first registration.
+    static double ns_per_tick(const Registry& r) {
+#if defined(__x86_64__) || defined(__i386__)
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - r.time0).count();
+        uint64_t ticks = now() - r.tick0;
+        return ticks ? ns / static_cast<double>(ticks) : 0.0;
+#else
+        (void)r;
+        return 1.0;
+#endif
+    }
+
+    struct ThreadBlock {
+        std::vector<std::unique_ptr<QJSProfileCounters[]>> chunks;
+
+        ThreadBlock() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mu);
+            r.threads.push_back(this);
+        }
+        ~ThreadBlock() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mu);
+            if (r.retired.size() < chunks.size() * kChunk) {
+                std::vector<QJSProfileCounters> grown(chunks.size() * kChunk);
+                for (size_t i = 0; i < r.retired.size(); ++i) move_counts(grown[i], r.retired[i]);
+                r.retired.swap(grown);
+            }
+            for (size_t i = 0; i < chunks.size() * kChunk; ++i) move_counts(r.retired[i], chunks[i / kChunk][i % kChunk]);
+            r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+        }
+        // Growing races with snapshot() walking the chunk list, so it takes the lock.
+        void grow(size_t n) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mu);
+            while (chunks.size() < n) chunks.emplace_back(new QJSProfileCounters[kChunk]);
+        }
+        static void move_counts(QJSProfileCounters& dst, const QJSProfileCounters& src) {
+            QJSProfileCounters::bump(dst.calls, src.calls.load(std::memory_order_relaxed));
+            QJSProfileCounters::bump(dst.args, src.args.load(std::memory_order_relaxed));
+            QJSProfileCounters::bump(dst.native, src.native.load(std::memory_order_relaxed));
+            QJSProfileCounters::bump(dst.ret, src.ret.load(std::memory_order_relaxed));
+        }
+    };
+};
+
+// Times one scope into a single phase (generated getters: return, setters: args).
+class QJSProfileScope {
+    QJSProfileCounters& c_;
+    QJSProfiler::Phase phase_;
+    uint64_t start_;
+
+public:
+    QJSProfileScope(uint32_t site, QJSProfiler::Phase phase)
+        : c_(QJSProfiler::local(site)), phase_(phase), start_(QJSProfiler::now()) {}
+    ~QJSProfileScope() {
+        QJSProfileCounters::bump(c_.calls, 1);
+        QJSProfileCounters::bump(c_.*phase_, QJSProfiler::now() - start_);
+    }
+};
+
+// JS side: __bindingStats(reset = false) returns the JSON table parsed into an array.
+inline JSValue qjs_binding_stats_js(JSContext* ctx, JSValueConst, int argc, JSValueConst* argv) {
+    std::string json = QJSProfiler::json();
+    if (argc > 0 && JS_ToBool(ctx, argv[0]) == 1) QJSProfiler::reset();
+    return JS_ParseJSON(ctx, json.c_str(), json.size(), "<bindingStats>");
+}
+#endif
+
+// Readable name of a bound function, taken from the compiler's signature string
+// ("... [with auto Func = add]", "... [Func = &add]").
+inline std::string qjs_binding_name_from(const std::string& sig) {
+    size_t at = sig.find("Func = ");
+    if (at == std::string::npos) return sig;
+    std::string n = sig.substr(at + 7);
+    n = n.substr(0, n.find_first_of(";]"));
+    if (!n.empty() && n[0] == '&') n.erase(0, 1);
+    // Default-argument adapters (qjs_default_args_S::m) report the method they call
+    if (n.compare(0, 17, "qjs_default_args_") == 0) n.erase(0, 17);
+    return n;
+}
+
+template<auto Func>
+const std::string& qjs_binding_name() {
+#ifdef _MSC_VER
+    static const std::string name = qjs_binding_name_from(__FUNCSIG__);
+#else
+    static const std::string name = qjs_binding_name_from(__PRETTY_FUNCTION__);
+#endif
+    return name;
+}
+
+// JS-facing name of a binding: generated adapters (qjs_buf_*, qjs_borrow_*, qjs_cb_*) are
+// registered under the wrapped function's name.
+inline std::string qjs_js_binding_name(std::string n) {
+    for (const char* prefix : {"qjs_buf_", "qjs_borrow_", "qjs_cb_"}) {
+        if (n.compare(0, std::strlen(prefix), prefix) == 0) return n.substr(std::strlen(prefix));
+    }
+    return n;
+}
+
+// Unqualified type name ("User" for ns::User), for argument error messages.
+inline std::string qjs_type_name_from(const std::string& sig) {
+#ifdef _MSC_VER
+    size_t at = sig.find("qjs_type_name<");
+    std::string n = at == std::string::npos ? sig : sig.substr(at + 14, sig.rfind(">(") - at - 14);
+    for (const char* tag : {"struct ", "class ", "enum "}) {
+        if (n.compare(0, std::strlen(tag), tag) == 0) n.erase(0, std::strlen(tag));
+    }
+#else
+    size_t at = sig.find("T = ");
+    if (at == std::string::npos) return sig;
+    std::string n = sig.substr(at + 4);
+    n = n.substr(0, n.find_first_of(";]"));
+#endif
+    size_t colon = n.rfind("::", n.find('<'));
+    return colon == std::string::npos ? n : n.substr(colon + 2);
+}
+
+template<typename T>
+const std::string& qjs_type_name() {
+#ifdef _MSC_VER
+    static const std::string name = qjs_type_name_from(__FUNCSIG__);
+#else
+    static const std::string name = qjs_type_name_from(__PRETTY_FUNCTION__);
+#endif
+    return name;
+}
+
 // [New] Forward declaration or definition for QJSCallback if not defined elsewhere
 // This ensures it is available for js_to_cpp specialization
 #ifndef QJS_CALLBACK_DEFINED
@@ -28,165 +352,2923 @@ struct QJSCallback {
 #endif
 
 // --- 1. Type Traits for Class ID Mapping ---
+// All members are written exactly once, inside qjs_class_id<T>'s one-time initialisation;
+// every thread that initialises a module goes through it, so later reads need no lock.
 template<typename T>
 struct JSClassIdTraits {
     inline static JSClassID id = 0;
+    // [New] Lazy modules: registers the class and builds its prototype in `ctx` on first use.
+    // Null when the module was generated with eager initialisation.
+    inline static int (*materialize)(JSContext*) = nullptr;
+    // assign() of the struct's field table on a raw T*: a plain object written to a T member
+    // of another struct updates that member field by field. Null for structs without fields.
+    inline static JSValue (*assign)(JSContext*, void*, JSValueConst) = nullptr;
 };
 
-// --- 2. Conversion: JS -> C++ ---
+// Classes a module init touched, collected while a module template is being built.
+struct QJSClassRecord {
+    JSClassID id;
+    int (*materialize)(JSContext*); // no-op for eagerly initialised modules
+};
+inline std::vector<QJSClassRecord>*& qjs_class_recorder() {
+    thread_local std::vector<QJSClassRecord>* recorder = nullptr;
+    return recorder;
+}
 
-template <typename T>
-T js_to_cpp(JSContext* ctx, JSValueConst val) {
-    using BaseType = std::decay_t<std::remove_pointer_t<T>>;
+// [New] Process-wide class ID allocation. quickjs-ng derives a new class ID from the class
+// count of the runtime it is given, so two runtimes initialising at once, or a lazy module
+// allocating several IDs before registering any class, could be handed the same ID. IDs are
+// therefore taken under one lock and never below an ID handed out before, whichever
+// runtime asks. Classes the host creates through JS_NewClassID are not covered and may
+// own one of these IDs on their runtime; qjs_register_class detects that.
+inline JSClassID qjs_allocate_class_id(JSRuntime* rt) {
+    static std::mutex mu;
+    static JSClassID next = 0;
+    std::lock_guard<std::mutex> lock(mu);
+    JSClassID v = 0;
+    JSClassID id = std::max(JS_NewClassID(rt, &v), next);
+    next = id + 1;
+    return id;
+}
 
-    // [Special] QJSCallback
-    if constexpr (std::is_same_v<T, QJSCallback>) {
-        if (!JS_IsFunction(ctx, val)) return {ctx, JS_UNDEFINED};
-        return {ctx, val};
+// Each bound struct gets one class ID for the whole process, allocated exactly once (the
+// function-local static makes this thread-safe) and used on every runtime and context
+// that imports it. The traits are filled in by the same one-time initialisation, so concurrent
+// module inits on different runtimes never write them.
+template<typename T>
+JSClassID qjs_class_id(JSRuntime* rt, int (*materialize)(JSContext*) = nullptr,
+                       JSValue (*assign)(JSContext*, void*, JSValueConst) = nullptr) {
+    static const JSClassID id = [rt, materialize, assign] {
+        JSClassID v = qjs_allocate_class_id(rt);
+        JSClassIdTraits<T>::materialize = materialize;
+        JSClassIdTraits<T>::assign = assign;
+        JSClassIdTraits<T>::id = v;
+        return v;
+    }();
+    if (auto* recorder = qjs_class_recorder()) {
+        recorder->push_back({id, [](JSContext* ctx) {
+            auto lazy = JSClassIdTraits<T>::materialize;
+            return lazy ? lazy(ctx) : 0;
+        }});
     }
+    return id;
+}
 
-    // Struct / Class Object
-    if (JSClassIdTraits<BaseType>::id != 0) {
-        void* opaque = JS_GetOpaque(val, JSClassIdTraits<BaseType>::id);
+// True once `ctx` has a prototype for the class (lazy modules build it on first use).
+inline bool qjs_has_class_proto(JSContext* ctx, JSClassID id) {
+    JSValue proto = JS_GetClassProto(ctx, id);
+    bool ready = JS_IsObject(proto);
+    JS_FreeValue(ctx, proto);
+    return ready;
+}
 
-        if (!opaque) {
-            if (JS_IsNull(val) || JS_IsUndefined(val)) {
-                if constexpr (std::is_pointer_v<T>) return nullptr;
-                else return BaseType{};
-            }
-            // std::cerr << "[QJS Error] Invalid object type" << std::endl;
-            if constexpr (std::is_pointer_v<T>) return nullptr;
-            else return BaseType{};
+// --- 2. Per-Runtime State & Object Pool ---
+// Struct instances owned by JS (generated ctor, by-value returns) are carved out of
+// per-runtime, per-class slabs instead of going through malloc/free each time.
+// The state lives in a registry keyed by JSRuntime* (the runtime opaque belongs to
+// the host, e.g. quickjs-libc) and is released by a runtime finalizer.
+// Define QJS_DISABLE_OBJECT_POOL to fall back to plain new/delete everywhere.
+
+// Opt-out per class: the generator specializes this to false_type for structs
+// listed in `no_pool_structs`.
+template<typename T>
+struct QJSUsePool
+#ifdef QJS_DISABLE_OBJECT_POOL
+    : std::false_type {};
+#else
+    : std::true_type {};
+#endif
+
+struct QJSPoolStats {
+    uint64_t allocs = 0;   // objects constructed
+    uint64_t frees = 0;    // objects destroyed
+    uint64_t reused = 0;   // allocations served without growing the pool
+    uint64_t live = 0;     // currently alive
+    uint64_t peak = 0;     // high-water mark of `live`
+    uint64_t slabs = 0;    // slabs requested from the system allocator
+    uint64_t capacity = 0; // total slots across all slabs
+};
+
+// Base of everything a binding attaches to a runtime (pools, atom tables, ...).
+struct QJSRuntimeSlot {
+    virtual ~QJSRuntimeSlot() = default;
+};
+
+template<typename T>
+class QJSObjectPool : public QJSRuntimeSlot {
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    struct Slab {
+        uintptr_t begin, end;
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    static constexpr size_t kFirstSlab = 32;
+    static constexpr size_t kMaxSlab = 4096;
+
+    std::vector<Slab> slabs_; // sorted by address for owns()
+    Slot* free_ = nullptr;
+    size_t next_slab_ = kFirstSlab;
+    QJSPoolStats stats_;
+
+    Slot* grow() {
+        size_t n = next_slab_;
+        next_slab_ = std::min(next_slab_ * 2, kMaxSlab);
+        Slab slab;
+        slab.slots.reset(new Slot[n]);
+        slab.begin = reinterpret_cast<uintptr_t>(slab.slots.get());
+        slab.end = slab.begin + n * sizeof(Slot);
+        // Slot 0 is handed out right away, the rest goes onto the free list.
+        for (size_t i = n - 1; i > 0; --i) {
+            slab.slots[i].next = free_;
+            free_ = &slab.slots[i];
         }
+        Slot* first = &slab.slots[0];
+        auto pos = std::upper_bound(slabs_.begin(), slabs_.end(), slab.begin,
+                                    [](uintptr_t a, const Slab& s) { return a < s.begin; });
+        slabs_.insert(pos, std::move(slab));
+        stats_.slabs++;
+        stats_.capacity += n;
+        return first;
+    }
 
-        if constexpr (std::is_pointer_v<T>) {
-            return static_cast<T>(opaque);
+public:
+    template<typename... A>
+    T* create(A&&... args) {
+        Slot* s = free_;
+        if (s) {
+            free_ = s->next;
+            stats_.reused++;
         } else {
-            return *static_cast<BaseType*>(opaque);
+            s = grow();
+        }
+        T* p;
+#ifdef QJS_NO_EXCEPTIONS
+        p = ::new (static_cast<void*>(s->storage)) T(std::forward<A>(args)...);
+#else
+        try {
+            p = ::new (static_cast<void*>(s->storage)) T(std::forward<A>(args)...);
+        } catch (...) {
+            s->next = free_;
+            free_ = s;
+            throw;
         }
+#endif
+        stats_.allocs++;
+        if (++stats_.live > stats_.peak) stats_.peak = stats_.live;
+        return p;
     }
 
-    // Integers
-    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
-        int64_t res;
-        if (JS_IsBigInt(val)) JS_ToBigInt64(ctx, &res, val);
-        else JS_ToInt64(ctx, &res, val);
-        return static_cast<T>(res);
+    bool owns(const void* p) const {
+        uintptr_t a = reinterpret_cast<uintptr_t>(p);
+        auto it = std::upper_bound(slabs_.begin(), slabs_.end(), a,
+                                   [](uintptr_t v, const Slab& s) { return v < s.begin; });
+        if (it == slabs_.begin()) return false;
+        --it;
+        return a < it->end;
     }
-    // Floats
-    else if constexpr (std::is_floating_point_v<T>) {
-        double res; JS_ToFloat64(ctx, &res, val); return static_cast<T>(res);
+
+    void destroy(T* p) {
+        p->~T();
+        Slot* s = reinterpret_cast<Slot*>(p);
+        s->next = free_;
+        free_ = s;
+        stats_.frees++;
+        stats_.live--;
     }
-    // Bool
-    else if constexpr (std::is_same_v<T, bool>) {
-        return (bool)JS_ToBool(ctx, val);
+
+    const QJSPoolStats& stats() const { return stats_; }
+};
+
+class QJSRuntimeState {
+    JSRuntime* rt_;
+    std::vector<std::unique_ptr<QJSRuntimeSlot>> slots_; // indexed by type slot
+
+    struct Registry {
+        std::mutex mu;
+        std::unordered_map<JSRuntime*, QJSRuntimeState*> states;
+        std::atomic<uint64_t> epoch{0}; // bumped on every release, invalidates TLS caches
+    };
+    static Registry& registry() {
+        static Registry r;
+        return r;
     }
-    // std::string
-    else if constexpr (std::is_same_v<T, std::string>) {
-        const char* str = JS_ToCString(ctx, val);
-        if (!str) return std::string("");
-        std::string res(str);
-        JS_FreeCString(ctx, str);
-        return res;
+
+    static size_t next_type_slot() {
+        static std::atomic<size_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed);
     }
-    // const char*
-    else if constexpr (std::is_same_v<T, const char*>) {
-        return JS_ToCString(ctx, val);
+    template<typename T>
+    static size_t type_slot() {
+        static const size_t slot = next_type_slot();
+        return slot;
     }
-    // Enums
-    else if constexpr (std::is_enum_v<T>) {
-        int32_t res; JS_ToInt32(ctx, &res, val); return static_cast<T>(res);
+
+    static void on_runtime_free(JSRuntime* rt, void* arg) {
+        auto* state = static_cast<QJSRuntimeState*>(arg);
+        Registry& r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mu);
+            r.states.erase(rt);
+            r.epoch.fetch_add(1, std::memory_order_release);
+        }
+        delete state;
     }
-    // Pointers (Generic)
-    else if constexpr (std::is_pointer_v<T>) {
-        if (JS_IsNull(val) || JS_IsUndefined(val)) return nullptr;
 
-        // [New] Allow string to char* (if T is char* or void*)
-        // This is dangerous but useful for APIs like lv_img_set_src taking file paths
-        if (JS_IsString(val)) return (T)JS_ToCString(ctx, val);
+    explicit QJSRuntimeState(JSRuntime* rt) : rt_(rt) {}
 
-        int64_t ptr_val = 0;
-        if (JS_IsBigInt(val)) JS_ToBigInt64(ctx, &ptr_val, val);
-        else JS_ToInt64(ctx, &ptr_val, val);
+public:
+    // Returns the state of `rt`, or nullptr if nothing has been allocated on it yet.
+    static QJSRuntimeState* find(JSRuntime* rt) {
+        thread_local JSRuntime* cached_rt = nullptr;
+        thread_local QJSRuntimeState* cached = nullptr;
+        thread_local uint64_t cached_epoch = 0;
+        Registry& r = registry();
+        uint64_t epoch = r.epoch.load(std::memory_order_acquire);
+        if (cached_rt == rt && cached_epoch == epoch) return cached;
+        std::lock_guard<std::mutex> lock(r.mu);
+        auto it = r.states.find(rt);
+        if (it == r.states.end()) return nullptr;
+        cached_rt = rt;
+        cached = it->second;
+        cached_epoch = epoch;
+        return cached;
+    }
 
-        return reinterpret_cast<T>(static_cast<uintptr_t>(ptr_val));
+    static QJSRuntimeState& get(JSRuntime* rt) {
+        if (QJSRuntimeState* s = find(rt)) return *s;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        QJSRuntimeState*& slot = r.states[rt];
+        if (!slot) {
+            slot = new QJSRuntimeState(rt);
+            JS_AddRuntimeFinalizer(rt, &QJSRuntimeState::on_runtime_free, slot);
+        }
+        return *slot;
     }
 
-    return T{};
-}
+    JSRuntime* runtime() const { return rt_; }
 
-// --- 3. Conversion: C++ -> JS ---
+    // Per-runtime instance of S (a QJSRuntimeSlot), default-constructed on first use.
+    template<typename S>
+    S& slot() {
+        size_t idx = type_slot<S>();
+        if (idx >= slots_.size()) slots_.resize(idx + 1);
+        if (!slots_[idx]) slots_[idx].reset(new S());
+        return *static_cast<S*>(slots_[idx].get());
+    }
 
-template <typename T>
-JSValue cpp_to_js(JSContext* ctx, T val) {
-    using BaseType = std::decay_t<std::remove_pointer_t<T>>;
+    template<typename S>
+    S* find_slot() {
+        size_t idx = type_slot<S>();
+        if (idx >= slots_.size()) return nullptr;
+        return static_cast<S*>(slots_[idx].get());
+    }
 
-    // Struct Value (T = Config)
-    if constexpr (!std::is_pointer_v<T> && !std::is_void_v<T> && !std::is_integral_v<T> && !std::is_floating_point_v<T> && !std::is_same_v<T, std::string> && !std::is_same_v<T, const char*> && !std::is_enum_v<T>) {
-        if (JSClassIdTraits<BaseType>::id != 0) {
-            JSValue obj = JS_NewObjectClass(ctx, JSClassIdTraits<BaseType>::id);
-            if (JS_IsException(obj)) return obj;
-            BaseType* ptr = new BaseType(val);
-            JS_SetOpaque(obj, ptr);
-            return obj;
-        }
+    template<typename T>
+    QJSObjectPool<T>& pool() { return slot<QJSObjectPool<T>>(); }
+
+    template<typename T>
+    QJSObjectPool<T>* find_pool() { return find_slot<QJSObjectPool<T>>(); }
+};
+
+// [FIX] Class IDs registered by the bindings on a runtime. A registered ID alone does not
+// prove the class is ours: quickjs-ng allocates IDs per runtime, so a host class may sit
+// in the slot.
+struct QJSClassSlot : QJSRuntimeSlot {
+    std::vector<bool> ours; // indexed by class ID
+};
+
+inline bool qjs_class_registered(JSRuntime* rt, JSClassID id) {
+    QJSRuntimeState* state = QJSRuntimeState::find(rt);
+    QJSClassSlot* classes = state ? state->find_slot<QJSClassSlot>() : nullptr;
+    return classes && id < classes->ours.size() && classes->ours[id];
+}
+
+// Registers the class with the context's runtime unless an earlier context on the same
+// runtime already did. Throws (returns -1) when a class the bindings did not register owns
+// the ID, instead of silently sharing its finalizer and prototype.
+inline int qjs_register_class(JSContext* ctx, JSClassID id, const JSClassDef* def) {
+    JSRuntime* rt = JS_GetRuntime(ctx);
+    if (qjs_class_registered(rt, id)) return 0;
+    if (JS_IsRegisteredClass(rt, id)) {
+        JS_ThrowInternalError(ctx, "class %s: id %u is already taken by another class on this runtime",
+                              def->class_name, static_cast<unsigned>(id));
+        return -1;
     }
+    if (JS_NewClass(rt, id, def) < 0) return -1;
+    std::vector<bool>& ours = QJSRuntimeState::get(rt).slot<QJSClassSlot>().ours;
+    if (id >= ours.size()) ours.resize(id + 1);
+    ours[id] = true;
+    return 0;
+}
 
-    // Pointers (T = User*)
-    if constexpr (std::is_pointer_v<T>) {
-        if (val == nullptr) return JS_NULL;
+// Allocates a JS-owned T, from the runtime's pool unless the class opted out.
+template<typename T, typename... A>
+T* qjs_create(JSRuntime* rt, A&&... args) {
+    if constexpr (QJSUsePool<T>::value) {
+        return QJSRuntimeState::get(rt).pool<T>().create(std::forward<A>(args)...);
+    } else {
+        return new T(std::forward<A>(args)...);
+    }
+}
 
-        // Struct Pointer
-        if (JSClassIdTraits<BaseType>::id != 0) {
-            JSValue obj = JS_NewObjectClass(ctx, JSClassIdTraits<BaseType>::id);
-            if (JS_IsException(obj)) return obj;
-            // [FIX] Cast away const because JS_SetOpaque takes void*
-            JS_SetOpaque(obj, const_cast<void*>(static_cast<const void*>(val)));
-            return obj;
+// Releases an object created by qjs_create<T> (or a plain `new T`, e.g. a pointer
+// handed over by a factory function): pool-owned slots go back to the free list.
+template<typename T>
+void qjs_destroy(JSRuntime* rt, T* ptr) {
+    if constexpr (QJSUsePool<T>::value) {
+        if (QJSRuntimeState* state = QJSRuntimeState::find(rt)) {
+            QJSObjectPool<T>* pool = state->find_pool<T>();
+            if (pool && pool->owns(ptr)) {
+                pool->destroy(ptr);
+                return;
+            }
         }
+    }
+    delete ptr;
+}
 
-        // Generic Pointer -> BigInt
-        return JS_NewBigInt64(ctx, static_cast<int64_t>(reinterpret_cast<uintptr_t>(val)));
+template<typename T>
+QJSPoolStats qjs_pool_stats(JSRuntime* rt) {
+    if (QJSRuntimeState* state = QJSRuntimeState::find(rt)) {
+        if (QJSObjectPool<T>* pool = state->find_pool<T>()) return pool->stats();
     }
+    return {};
+}
 
-    // Basic Types
-    if constexpr (std::is_void_v<T>) return JS_UNDEFINED;
-    else if constexpr (std::is_same_v<T, int> || std::is_same_v<T, int32_t>) return JS_NewInt32(ctx, val);
-    else if constexpr (std::is_same_v<T, uint32_t> || std::is_same_v<T, int64_t>) return JS_NewInt64(ctx, static_cast<int64_t>(val));
-    else if constexpr (std::is_floating_point_v<T>) return JS_NewFloat64(ctx, val);
-    else if constexpr (std::is_same_v<T, bool>) return JS_NewBool(ctx, val);
-    else if constexpr (std::is_same_v<T, std::string>) return JS_NewString(ctx, val.c_str());
-    else if constexpr (std::is_same_v<T, const char*>) return JS_NewString(ctx, val ? val : "");
-    else if constexpr (std::is_enum_v<T>) return JS_NewInt32(ctx, static_cast<int32_t>(val));
+// [New] Ownership of wrapped struct pointers. The opaque of a struct object is either
+//  - the object itself: JS owns it (generated ctor, by-value returns, QJS_OWNED pointer
+//    returns) and the finalizer destroys it, or
+//  - a QJSRef<T> tagged with the low bit: QJS_BORROWED and std::shared_ptr returns. The
+//    finalizer drops the ref (and the shared_ptr count it holds), never the object.
+//    Nested struct fields are refs too: a view into the parent's storage whose `owner`
+//    keeps the parent's JS object alive (reported to the GC through the class gc_mark).
+// JS-owned objects come from the pool or operator new, so their low bit is always clear.
 
-    return JS_NULL;
+// Result marker for QJS_BORROWED functions: the caller keeps ownership.
+template<typename T>
+struct QJSBorrowed {
+    T* ptr = nullptr;
+};
+
+template<typename T>
+QJSBorrowed<T> qjs_borrow(T* ptr) { return {ptr}; }
+
+template<typename T> struct is_qjs_borrowed : std::false_type {};
+template<typename T> struct is_qjs_borrowed<QJSBorrowed<T>> : std::true_type {};
+template<typename T> struct is_std_shared_ptr : std::false_type {};
+template<typename T> struct is_std_shared_ptr<std::shared_ptr<T>> : std::true_type {};
+
+template<typename T>
+struct QJSRef {
+    T* ptr = nullptr;
+    std::shared_ptr<T> keep; // empty for borrowed objects
+    JSValue owner = JS_UNDEFINED; // object whose storage `ptr` points into (field views)
+};
+
+inline constexpr uintptr_t kQJSRefTag = 1;
+
+template<typename T>
+QJSRef<T>* qjs_opaque_ref(void* opaque) {
+    auto bits = reinterpret_cast<uintptr_t>(opaque);
+    return (bits & kQJSRefTag) ? reinterpret_cast<QJSRef<T>*>(bits & ~kQJSRefTag) : nullptr;
 }
 
-// --- 4. Wrapper Helper ---
+// The object behind the opaque of a T instance (nullptr stays nullptr).
+template<typename T>
+T* qjs_opaque_ptr(void* opaque) {
+    if (QJSRef<T>* ref = qjs_opaque_ref<T>(opaque)) return ref->ptr;
+    return static_cast<T*>(opaque);
+}
 
-template<auto Func>
-struct Wrapper;
+template<typename T>
+T* qjs_unwrap(JSValueConst val) {
+    return qjs_opaque_ptr<T>(JS_GetOpaque(val, JSClassIdTraits<T>::id));
+}
 
-template<typename R, typename... Args, R(*Func)(Args...)>
-struct Wrapper<Func> {
-    template<std::size_t... Is>
-    static JSValue call_impl(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
-        if constexpr (std::is_void_v<R>) {
-            Func(js_to_cpp<std::decay_t<Args>>(ctx, argv[Is])...);
-            return JS_UNDEFINED;
-        } else {
-            return cpp_to_js(ctx, Func(js_to_cpp<std::decay_t<Args>>(ctx, argv[Is])...));
-        }
+// Finalizer side: destroys JS-owned objects, only releases refs.
+template<typename T>
+void qjs_release_opaque(JSRuntime* rt, void* opaque) {
+    if (!opaque) return;
+    if (QJSRef<T>* ref = qjs_opaque_ref<T>(opaque)) {
+        JS_FreeValueRT(rt, ref->owner);
+        qjs_destroy<QJSRef<T>>(rt, ref);
     }
+    else qjs_destroy<T>(rt, static_cast<T*>(opaque));
+}
 
-    static JSValue call(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-        try {
-            if (argc < (int)sizeof...(Args)) {
-                return JS_ThrowTypeError(ctx, "Arg count mismatch");
+// GC side: a field view references its owner, so parent <-> view cycles stay collectable.
+template<typename T>
+void qjs_mark_opaque(JSRuntime* rt, void* opaque, JS_MarkFunc* mark_func) {
+    if (QJSRef<T>* ref = qjs_opaque_ref<T>(opaque)) JS_MarkValue(rt, ref->owner, mark_func);
+}
+
+// Interned property names. Generated modules list every name they touch (enum
+// members, fields, ...) once and index the table instead of passing C strings, so
+// nothing is re-hashed per call. Atoms belong to the runtime, so the table is built
+// once per runtime (on the first module init) and shared by all of its contexts; it
+// goes away together with the runtime's atom table.
+template<typename Tag>
+struct QJSAtomTable : QJSRuntimeSlot {
+    std::vector<JSAtom> atoms;
+};
+
+// Returns `count` atoms for `names`, or nullptr if interning failed (exception set).
+template<typename Tag>
+const JSAtom* qjs_atoms(JSContext* ctx, const char* const* names, size_t count) {
+    auto& table = QJSRuntimeState::get(JS_GetRuntime(ctx)).slot<QJSAtomTable<Tag>>();
+    if (table.atoms.size() != count) {
+        table.atoms.clear();
+        table.atoms.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            JSAtom atom = JS_NewAtom(ctx, names[i]);
+            if (atom == JS_ATOM_NULL) {
+                for (JSAtom a : table.atoms) JS_FreeAtom(ctx, a);
+                table.atoms.clear();
+                return nullptr;
             }
-            return call_impl(ctx, argv, std::make_index_sequence<sizeof...(Args)>{});
-        } catch (...) {
-            return JS_ThrowInternalError(ctx, "C++ Exception");
+            table.atoms.push_back(atom);
         }
     }
-};
\ No newline at end of file
+    return table.atoms.data();
+}
+
+// --- 3. Zero-Copy Buffer Views ---
+// QJSBufferView<T> borrows the memory of an ArrayBuffer / TypedArray for the duration
+// of a call. The generator maps `T* data, size_t len` parameter pairs onto it, so a
+// Float32Array reaches `const float*` without a copy. Writes through a non-const view
+// land directly in the JS buffer.
+
+template<typename T>
+struct QJSBufferView {
+    using element_type = T;
+    T* ptr = nullptr;
+    size_t len = 0;
+
+    T* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    T& operator[](size_t i) const { return ptr[i]; }
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + len; }
+};
+
+template<typename T> struct is_qjs_buffer_view : std::false_type {};
+template<typename T> struct is_qjs_buffer_view<QJSBufferView<T>> : std::true_type {};
+
+#ifdef QJS_HAS_SPAN
+template<typename T> struct is_std_span : std::false_type {};
+template<typename T> struct is_std_span<std::span<T>> : std::true_type {};
+#endif
+
+// Element types that have a matching TypedArray kind (bool is deliberately excluded).
+template<typename T>
+inline constexpr bool qjs_is_typed_element_v =
+    std::is_arithmetic_v<std::remove_cv_t<T>> && !std::is_same_v<std::remove_cv_t<T>, bool>;
+
+template<typename T> struct is_qjs_numeric_vector : std::false_type {};
+template<typename T, typename A>
+struct is_qjs_numeric_vector<std::vector<T, A>> : std::bool_constant<qjs_is_typed_element_v<T>> {};
+template<typename T> struct is_qjs_numeric_array : std::false_type {};
+template<typename T, size_t N>
+struct is_qjs_numeric_array<std::array<T, N>> : std::bool_constant<qjs_is_typed_element_v<T>> {};
+
+template<typename T>
+constexpr int qjs_typed_array_type() {
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_same_v<U, float>) return JS_TYPED_ARRAY_FLOAT32;
+    else if constexpr (std::is_same_v<U, double>) return JS_TYPED_ARRAY_FLOAT64;
+    else if constexpr (qjs_is_typed_element_v<U> && std::is_integral_v<U>) {
+        constexpr bool s = std::is_signed_v<U>;
+        if constexpr (sizeof(U) == 1) return s ? JS_TYPED_ARRAY_INT8 : JS_TYPED_ARRAY_UINT8;
+        else if constexpr (sizeof(U) == 2) return s ? JS_TYPED_ARRAY_INT16 : JS_TYPED_ARRAY_UINT16;
+        else if constexpr (sizeof(U) == 4) return s ? JS_TYPED_ARRAY_INT32 : JS_TYPED_ARRAY_UINT32;
+        else if constexpr (sizeof(U) == 8) return s ? JS_TYPED_ARRAY_BIG_INT64 : JS_TYPED_ARRAY_BIG_UINT64;
+    }
+    return -1;
+}
+
+// Byte-sized elements accept any byte array (Uint8Array, Int8Array, Uint8ClampedArray).
+template<typename T>
+constexpr bool qjs_typed_array_accepts(int type) {
+    if constexpr (sizeof(T) == 1 && std::is_integral_v<std::remove_cv_t<T>>) {
+        return type == JS_TYPED_ARRAY_UINT8 || type == JS_TYPED_ARRAY_INT8 || type == JS_TYPED_ARRAY_UINT8C;
+    } else {
+        return type == qjs_typed_array_type<T>();
+    }
+}
+
+template<typename T>
+constexpr const char* qjs_typed_array_name() {
+    switch (qjs_typed_array_type<T>()) {
+        case JS_TYPED_ARRAY_INT8: return "Int8Array";
+        case JS_TYPED_ARRAY_UINT8: return "Uint8Array";
+        case JS_TYPED_ARRAY_INT16: return "Int16Array";
+        case JS_TYPED_ARRAY_UINT16: return "Uint16Array";
+        case JS_TYPED_ARRAY_INT32: return "Int32Array";
+        case JS_TYPED_ARRAY_UINT32: return "Uint32Array";
+        case JS_TYPED_ARRAY_BIG_INT64: return "BigInt64Array";
+        case JS_TYPED_ARRAY_BIG_UINT64: return "BigUint64Array";
+        case JS_TYPED_ARRAY_FLOAT32: return "Float32Array";
+        case JS_TYPED_ARRAY_FLOAT64: return "Float64Array";
+        default: return "TypedArray";
+    }
+}
+
+// Borrows the backing store of `val`. Returns an empty view for null/undefined,
+// non-buffer values and TypedArrays whose element type does not match T, and also when
+// QuickJS refuses the buffer (detached): the exception is then pending, so callers that
+// got an empty view for an accepted buffer check JS_HasException.
+template<typename T>
+QJSBufferView<T> qjs_buffer_view(JSContext* ctx, JSValueConst val) {
+    using U = std::remove_cv_t<T>;
+    if (!JS_IsObject(val)) return {};
+    size_t size = 0;
+    int type = JS_GetTypedArrayType(val);
+    if (type >= 0) {
+        if (!qjs_typed_array_accepts<U>(type)) return {};
+        if (type == JS_TYPED_ARRAY_UINT8) {
+            uint8_t* p = JS_GetUint8Array(ctx, &size, val);
+            return {reinterpret_cast<T*>(p), p ? size : 0};
+        }
+        size_t offset = 0, bytes = 0, bpe = 0;
+        JSValue buf = JS_GetTypedArrayBuffer(ctx, val, &offset, &bytes, &bpe);
+        if (JS_IsException(buf)) return {};
+        uint8_t* base = JS_GetArrayBuffer(ctx, &size, buf);
+        JS_FreeValue(ctx, buf); // the TypedArray keeps its buffer alive
+        if (!base) return {};
+        return {reinterpret_cast<T*>(base + offset), bytes / sizeof(U)};
+    }
+    if (JS_IsArrayBuffer(val)) {
+        uint8_t* base = JS_GetArrayBuffer(ctx, &size, val);
+        if (!base) return {};
+        return {reinterpret_cast<T*>(base), size / sizeof(U)};
+    }
+    return {};
+}
+
+// Wraps an ArrayBuffer in a TypedArray of element type T. Takes ownership of `buffer`.
+template<typename T>
+JSValue qjs_new_typed_array(JSContext* ctx, JSValue buffer, size_t length) {
+    if (JS_IsException(buffer)) return buffer;
+    JSValue args[3] = {buffer, JS_NewInt32(ctx, 0), JS_NewInt64(ctx, static_cast<int64_t>(length))};
+    JSValue arr = JS_NewTypedArray(ctx, 3, args, static_cast<JSTypedArrayEnum>(qjs_typed_array_type<T>()));
+    JS_FreeValue(ctx, buffer);
+    return arr;
+}
+
+// Copies borrowed C++ memory into a fresh TypedArray.
+template<typename T>
+JSValue qjs_typed_array_copy(JSContext* ctx, const T* data, size_t length) {
+    static const uint8_t empty = 0;
+    const uint8_t* bytes = length ? reinterpret_cast<const uint8_t*>(data) : &empty;
+    if constexpr (qjs_typed_array_type<T>() == JS_TYPED_ARRAY_UINT8) {
+        return JS_NewUint8ArrayCopy(ctx, bytes, length);
+    } else {
+        return qjs_new_typed_array<T>(ctx, JS_NewArrayBufferCopy(ctx, bytes, length * sizeof(T)), length);
+    }
+}
+
+// Hands a vector's storage to JS without copying; the ArrayBuffer frees it on GC.
+template<typename T>
+JSValue qjs_typed_array_adopt(JSContext* ctx, std::vector<T>&& vec) {
+    if (vec.empty()) return qjs_typed_array_copy<T>(ctx, nullptr, 0);
+    auto* owned = new std::vector<T>(std::move(vec));
+    JSFreeArrayBufferDataFunc* free_func = [](JSRuntime*, void* opaque, void*) {
+        delete static_cast<std::vector<T>*>(opaque);
+    };
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(owned->data());
+    if constexpr (qjs_typed_array_type<T>() == JS_TYPED_ARRAY_UINT8) {
+        return JS_NewUint8Array(ctx, bytes, owned->size(), free_func, owned, false);
+    } else {
+        size_t length = owned->size();
+        JSValue buf = JS_NewArrayBuffer(ctx, bytes, length * sizeof(T), free_func, owned, false);
+        return qjs_new_typed_array<T>(ctx, buf, length);
+    }
+}
+
+// --- 4. Conversion: JS -> C++ ---
+
+// [New] Standard containers. Numeric std::vector / std::array convert in bulk through
+// TypedArrays (see section 3); everything else maps onto plain JS values: vectors, arrays
+// and pairs onto Arrays, maps keyed by strings, numbers or enums onto objects, and
+// std::optional onto its value or null. Arrays are built with JS_NewArrayFrom, which
+// fills the fast-array storage in one step; QuickJS has no public accessor for that
+// storage, so they are read with indexed gets, which take its fast path.
+template<typename T> struct is_std_vector : std::false_type {};
+template<typename T, typename A> struct is_std_vector<std::vector<T, A>> : std::true_type {};
+template<typename T> struct is_std_array : std::false_type {};
+template<typename T, size_t N> struct is_std_array<std::array<T, N>> : std::true_type {};
+template<typename T> struct is_std_optional : std::false_type {};
+template<typename T> struct is_std_optional<std::optional<T>> : std::true_type {};
+template<typename T> struct is_std_pair : std::false_type {};
+template<typename A, typename B> struct is_std_pair<std::pair<A, B>> : std::true_type {};
+template<typename T> struct is_std_map : std::false_type {};
+template<typename K, typename V, typename C, typename A>
+struct is_std_map<std::map<K, V, C, A>> : std::true_type {};
+template<typename K, typename V, typename H, typename E, typename A>
+struct is_std_map<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool qjs_is_container_v = is_std_vector<T>::value || is_std_array<T>::value ||
+    is_std_optional<T>::value || is_std_pair<T>::value || is_std_map<T>::value;
+
+// Length of an Array (or, with `typed`, of a TypedArray too); -1 for anything else.
+inline int64_t qjs_array_length(JSContext* ctx, JSValueConst val, bool typed = false) {
+    int64_t len = 0;
+    if (!(JS_IsArray(val) || (typed && JS_GetTypedArrayType(val) >= 0)) || JS_GetLength(ctx, val, &len) < 0) return -1;
+    return len;
+}
+
+// Builds an Array from owned values. On failure the values are released and JS_EXCEPTION
+// is returned.
+inline JSValue qjs_new_array(JSContext* ctx, JSValue* items, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (!JS_IsException(items[i])) continue;
+        for (size_t j = 0; j < count; ++j) JS_FreeValue(ctx, items[j]);
+        return JS_EXCEPTION;
+    }
+    return JS_NewArrayFrom(ctx, static_cast<int>(count), items);
+}
+
+// Tag-switch fast paths: numbers that are already JS_TAG_INT / JS_TAG_FLOAT64 are read
+// straight from the JSValue payload. Anything else (strings, objects with valueOf,
+// BigInt, out-of-range doubles) returns false and takes the generic JS_To* path.
+// Define QJS_DISABLE_FAST_PATH to measure or bisect against the generic conversions.
+inline bool qjs_fast_int32(JSValueConst val, int32_t& out) {
+    switch (JS_VALUE_GET_NORM_TAG(val)) {
+        case JS_TAG_INT:
+            out = JS_VALUE_GET_INT(val);
+            return true;
+        case JS_TAG_BOOL:
+            out = JS_VALUE_GET_BOOL(val) ? 1 : 0;
+            return true;
+        case JS_TAG_FLOAT64: {
+            // Truncation matches JS_ToInt64 inside the int32 range; NaN and larger values go slow.
+            double d = JS_VALUE_GET_FLOAT64(val);
+            if (d > -2147483649.0 && d < 2147483648.0) {
+                out = static_cast<int32_t>(d);
+                return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+inline bool qjs_fast_float64(JSValueConst val, double& out) {
+    switch (JS_VALUE_GET_NORM_TAG(val)) {
+        case JS_TAG_FLOAT64:
+            out = JS_VALUE_GET_FLOAT64(val);
+            return true;
+        case JS_TAG_INT:
+            out = JS_VALUE_GET_INT(val);
+            return true;
+        case JS_TAG_BOOL:
+            out = JS_VALUE_GET_BOOL(val) ? 1.0 : 0.0;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// [New] Persistent function references (section 10). QJSCallback above only borrows the
+// function for the duration of one call; these keep it alive.
+template<typename Sig> class QJSFunction;
+template<typename Sig> class QJSQueuedFunction;
+template<typename Fp, bool Queued> class QJSCallbackArg;
+
+template<typename T> struct is_std_function : std::false_type {};
+template<typename Sig> struct is_std_function<std::function<Sig>> : std::true_type { using signature = Sig; };
+
+template<typename T> struct is_qjs_function_arg : std::false_type {};
+template<typename Sig> struct is_qjs_function_arg<std::function<Sig>> : std::true_type {};
+template<typename Sig> struct is_qjs_function_arg<QJSFunction<Sig>> : std::true_type {};
+template<typename Sig> struct is_qjs_function_arg<QJSQueuedFunction<Sig>> : std::true_type {};
+template<typename Fp, bool Q> struct is_qjs_function_arg<QJSCallbackArg<Fp, Q>> : std::true_type {};
+
+// Thrown by QJSFunction when the JS function threw; the JS exception is still pending, so
+// Wrapper returns JS_EXCEPTION and the original error reaches the script.
+struct QJSPendingException {};
+
+// Active while a bound function that received C callbacks runs. C trampolines cannot throw
+// through native frames, so a JS exception raised by a callback is left pending, later
+// callbacks of the same call are skipped, and check() rethrows it once the call returns.
+// In QJS_NO_EXCEPTIONS mode check() does nothing: Wrapper opens its own scope around calls
+// that take callbacks and returns JS_EXCEPTION when take_failure() reports one.
+class QJSCallbackScope {
+    static int& depth() {
+        thread_local int d = 0;
+        return d;
+    }
+    static bool& failed_flag() {
+        thread_local bool f = false;
+        return f;
+    }
+
+public:
+    QJSCallbackScope() { depth()++; }
+    ~QJSCallbackScope() { depth()--; }
+    QJSCallbackScope(const QJSCallbackScope&) = delete;
+    QJSCallbackScope& operator=(const QJSCallbackScope&) = delete;
+
+    static bool failed() { return failed_flag(); }
+    // False when no bound call is active to report the exception.
+    static bool capture() {
+        if (depth() == 0) return false;
+        failed_flag() = true;
+        return true;
+    }
+
+    static bool take_failure() { return std::exchange(failed_flag(), false); }
+
+    void check() {
+#ifndef QJS_NO_EXCEPTIONS
+        if (take_failure()) throw QJSPendingException{};
+#endif
+    }
+    template<typename R>
+    R check(R&& result) {
+        check();
+        return std::forward<R>(result);
+    }
+};
+
+// [FIX] Argument conversion for QJSBufferView / std::span parameters and the bulk copies of
+// numeric containers. null / undefined give an empty view; any other value that is not an
+// ArrayBuffer or an accepted TypedArray, or a detached buffer, is a TypeError instead of
+// an empty view. In QJS_NO_EXCEPTIONS mode qjs_arg_mismatch has already rejected both.
+template<typename T>
+QJSBufferView<T> qjs_buffer_arg(JSContext* ctx, JSValueConst val) {
+    using U = std::remove_cv_t<T>;
+    if (JS_IsNull(val) || JS_IsUndefined(val)) return {};
+    int type = JS_GetTypedArrayType(val);
+    if (type >= 0 ? qjs_typed_array_accepts<U>(type) : JS_IsArrayBuffer(val)) {
+        QJSBufferView<T> view = qjs_buffer_view<T>(ctx, val);
+        if (view.data() || !JS_HasException(ctx)) return view;
+    } else {
+        JS_ThrowTypeError(ctx, "expected %s", qjs_typed_array_name<U>());
+    }
+#ifndef QJS_NO_EXCEPTIONS
+    throw QJSPendingException{};
+#else
+    JS_FreeValue(ctx, JS_GetException(ctx)); // not reached after validation
+    return {};
+#endif
+}
+
+template <typename T>
+T js_to_cpp(JSContext* ctx, JSValueConst val) {
+    using BaseType = std::decay_t<std::remove_pointer_t<T>>;
+    static_assert(!std::is_same_v<T, std::string_view>,
+                  "std::string_view can only borrow a bound-call argument (qjs_arg); convert to std::string");
+
+    // [Special] QJSCallback
+    if constexpr (std::is_same_v<T, QJSCallback>) {
+        if (!JS_IsFunction(ctx, val)) return {ctx, JS_UNDEFINED};
+        return {ctx, val};
+    }
+    // std::function / QJSFunction / QJSQueuedFunction / C callback: null when not a function
+    else if constexpr (is_qjs_function_arg<T>::value) {
+        if constexpr (is_std_function<T>::value) {
+            using Sig = typename is_std_function<T>::signature;
+            return JS_IsFunction(ctx, val) ? T(QJSFunction<Sig>(ctx, val)) : T();
+        } else {
+            return T(ctx, val);
+        }
+    }
+
+    // std::shared_ptr<T>: shares the count of a shared_ptr-backed object. Any other object
+    // belongs to JS, a pool or C++ and the callee may keep the pointer, so it gets its own
+    // copy (a TypeError when T cannot be copied). null / undefined give an empty pointer,
+    // anything else that is not a T is a TypeError.
+    if constexpr (is_std_shared_ptr<T>::value) {
+        using E = std::remove_const_t<typename T::element_type>;
+        void* opaque = JSClassIdTraits<E>::id != 0 ? JS_GetOpaque(val, JSClassIdTraits<E>::id) : nullptr;
+        if (!opaque) {
+#ifndef QJS_NO_EXCEPTIONS
+            if (!JS_IsNull(val) && !JS_IsUndefined(val)) {
+                JS_ThrowTypeError(ctx, "expected %s", qjs_type_name<E>().c_str());
+                throw QJSPendingException{};
+            }
+#endif
+            return T();
+        }
+        if (QJSRef<E>* ref = qjs_opaque_ref<E>(opaque); ref && ref->keep) return ref->keep;
+        if constexpr (std::is_copy_constructible_v<E>) {
+            return std::make_shared<E>(*qjs_opaque_ptr<E>(opaque));
+        } else {
+#ifndef QJS_NO_EXCEPTIONS
+            JS_ThrowTypeError(ctx, "expected a shared %s", qjs_type_name<E>().c_str());
+            throw QJSPendingException{};
+#endif
+            return T();
+        }
+    }
+
+    // Struct / Class Object (scalars never carry a class id, so skip the lookup for them)
+    if (std::is_class_v<BaseType> && JSClassIdTraits<BaseType>::id != 0) {
+        void* opaque = JS_GetOpaque(val, JSClassIdTraits<BaseType>::id);
+
+        if (!opaque) {
+            if (JS_IsNull(val) || JS_IsUndefined(val)) {
+                if constexpr (std::is_pointer_v<T>) return nullptr;
+                else return BaseType{};
+            }
+            // std::cerr << "[QJS Error] Invalid object type" << std::endl;
+            if constexpr (std::is_pointer_v<T>) return nullptr;
+            else return BaseType{};
+        }
+
+        if constexpr (std::is_pointer_v<T>) {
+            return qjs_opaque_ptr<BaseType>(opaque);
+        } else {
+            return *qjs_opaque_ptr<BaseType>(opaque);
+        }
+    }
+
+    // Integers
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+#ifndef QJS_DISABLE_FAST_PATH
+        if (int32_t i; qjs_fast_int32(val, i)) return static_cast<T>(i);
+#endif
+        int64_t res;
+        if (JS_IsBigInt(val)) JS_ToBigInt64(ctx, &res, val);
+        else JS_ToInt64(ctx, &res, val);
+        return static_cast<T>(res);
+    }
+    // Floats
+    else if constexpr (std::is_floating_point_v<T>) {
+#ifndef QJS_DISABLE_FAST_PATH
+        if (double d; qjs_fast_float64(val, d)) return static_cast<T>(d);
+#endif
+        double res; JS_ToFloat64(ctx, &res, val); return static_cast<T>(res);
+    }
+    // Bool
+    else if constexpr (std::is_same_v<T, bool>) {
+#ifndef QJS_DISABLE_FAST_PATH
+        switch (JS_VALUE_GET_NORM_TAG(val)) {
+            case JS_TAG_BOOL: return JS_VALUE_GET_BOOL(val) != 0;
+            case JS_TAG_INT: return JS_VALUE_GET_INT(val) != 0;
+            case JS_TAG_NULL:
+            case JS_TAG_UNDEFINED: return false;
+            default: break;
+        }
+#endif
+        return (bool)JS_ToBool(ctx, val);
+    }
+    // std::string (one copy, length known: no strlen, embedded NULs kept)
+    else if constexpr (std::is_same_v<T, std::string>) {
+        size_t len = 0;
+        const char* str = JS_ToCStringLen(ctx, &len, val);
+        if (!str) return std::string("");
+        std::string res(str, len);
+        JS_FreeCString(ctx, str);
+        return res;
+    }
+    // const char*
+    else if constexpr (std::is_same_v<T, const char*>) {
+        return JS_ToCString(ctx, val);
+    }
+    // Enums
+    else if constexpr (std::is_enum_v<T>) {
+#ifndef QJS_DISABLE_FAST_PATH
+        if (JS_VALUE_GET_TAG(val) == JS_TAG_INT) return static_cast<T>(JS_VALUE_GET_INT(val));
+#endif
+        int32_t res; JS_ToInt32(ctx, &res, val); return static_cast<T>(res);
+    }
+    // Zero-copy views (ArrayBuffer / TypedArray)
+    else if constexpr (is_qjs_buffer_view<T>::value) {
+        return qjs_buffer_arg<typename T::element_type>(ctx, val);
+    }
+#ifdef QJS_HAS_SPAN
+    else if constexpr (is_std_span<T>::value) {
+        auto view = qjs_buffer_arg<typename T::element_type>(ctx, val);
+        return T(view.data(), view.size());
+    }
+#endif
+    // std::vector of numbers: one bulk copy from a matching TypedArray or an ArrayBuffer,
+    // element-wise from an Array or a TypedArray of another element type
+    else if constexpr (is_qjs_numeric_vector<T>::value) {
+        using E = typename T::value_type;
+        int type = JS_GetTypedArrayType(val);
+        if (type >= 0 ? qjs_typed_array_accepts<E>(type) : JS_IsArrayBuffer(val)) {
+            auto view = qjs_buffer_arg<const E>(ctx, val);
+            return T(view.begin(), view.end());
+        }
+        T res;
+        int64_t len = qjs_array_length(ctx, val, true);
+        if (len > 0) res.reserve(static_cast<size_t>(len));
+        for (int64_t i = 0; i < len; ++i) {
+            JSValue item = JS_GetPropertyInt64(ctx, val, i);
+            res.push_back(js_to_cpp<E>(ctx, item));
+            JS_FreeValue(ctx, item);
+        }
+        return res;
+    }
+    // Other vectors and std::array: element-wise from an Array (numeric std::array also
+    // takes one bulk copy from a matching TypedArray, and element-wise from any other);
+    // missing std::array elements stay zero
+    else if constexpr (is_std_vector<T>::value || is_std_array<T>::value) {
+        using E = typename T::value_type;
+        T res{};
+        if constexpr (is_qjs_numeric_array<T>::value) {
+            int type = JS_GetTypedArrayType(val);
+            if (type >= 0 ? qjs_typed_array_accepts<E>(type) : JS_IsArrayBuffer(val)) {
+                auto view = qjs_buffer_arg<const E>(ctx, val);
+                std::copy_n(view.begin(), std::min(view.size(), res.size()), res.begin());
+                return res;
+            }
+        }
+        int64_t len = qjs_array_length(ctx, val, is_qjs_numeric_array<T>::value);
+        if constexpr (is_std_vector<T>::value) {
+            if (len > 0) res.reserve(static_cast<size_t>(len));
+        } else {
+            len = std::min(len, static_cast<int64_t>(res.size()));
+        }
+        for (int64_t i = 0; i < len; ++i) {
+            JSValue item = JS_GetPropertyUint32(ctx, val, static_cast<uint32_t>(i));
+            if constexpr (is_std_vector<T>::value) res.push_back(js_to_cpp<E>(ctx, item));
+            else res[i] = js_to_cpp<E>(ctx, item);
+            JS_FreeValue(ctx, item);
+        }
+        return res;
+    }
+    // std::optional: null / undefined -> nullopt
+    else if constexpr (is_std_optional<T>::value) {
+        if (JS_IsNull(val) || JS_IsUndefined(val)) return std::nullopt;
+        return js_to_cpp<typename T::value_type>(ctx, val);
+    }
+    // std::pair from [first, second]
+    else if constexpr (is_std_pair<T>::value) {
+        if (!JS_IsObject(val)) return T{};
+        JSValue first = JS_GetPropertyUint32(ctx, val, 0);
+        JSValue second = JS_GetPropertyUint32(ctx, val, 1);
+        T res(js_to_cpp<typename T::first_type>(ctx, first), js_to_cpp<typename T::second_type>(ctx, second));
+        JS_FreeValue(ctx, first);
+        JS_FreeValue(ctx, second);
+        return res;
+    }
+    // std::map / std::unordered_map from the object's own enumerable string keys
+    else if constexpr (is_std_map<T>::value) {
+        using K = typename T::key_type;
+        static_assert(std::is_same_v<K, std::string> || std::is_arithmetic_v<K> || std::is_enum_v<K>,
+                      "map keys must be strings, numbers or enums to become JS property names");
+        T res;
+        JSPropertyEnum* props = nullptr;
+        uint32_t count = 0;
+        if (!JS_IsObject(val) ||
+            JS_GetOwnPropertyNames(ctx, &props, &count, val, JS_GPN_STRING_MASK | JS_GPN_ENUM_ONLY) < 0)
+            return res;
+        for (uint32_t i = 0; i < count; ++i) {
+            JSValue key = JS_AtomToValue(ctx, props[i].atom);
+            JSValue item = JS_GetProperty(ctx, val, props[i].atom);
+            res.emplace(js_to_cpp<K>(ctx, key), js_to_cpp<typename T::mapped_type>(ctx, item));
+            JS_FreeValue(ctx, key);
+            JS_FreeValue(ctx, item);
+        }
+        JS_FreePropertyEnum(ctx, props, count);
+        return res;
+    }
+    // Pointers (Generic)
+    else if constexpr (std::is_pointer_v<T>) {
+        if (JS_IsNull(val) || JS_IsUndefined(val)) return nullptr;
+
+        // [New] Allow string to char* (if T is char* or void*)
+        // This is dangerous but useful for APIs like lv_img_set_src taking file paths
+        if (JS_IsString(val)) return (T)JS_ToCString(ctx, val);
+
+        int64_t ptr_val = 0;
+        if (JS_IsBigInt(val)) JS_ToBigInt64(ctx, &ptr_val, val);
+        else JS_ToInt64(ctx, &ptr_val, val);
+
+        return reinterpret_cast<T>(static_cast<uintptr_t>(ptr_val));
+    }
+
+    return T{};
+}
+
+// [New] Bound-call argument storage. Usually the converted value itself; string views and
+// `const char*` borrow the UTF-8 buffer from JS_ToCStringLen instead, which stays valid until
+// the call returns (the storage outlives the call expression) and is then released.
+class QJSCStringArg {
+    JSContext* ctx_;
+    size_t len_ = 0;
+    const char* str_;
+
+public:
+    QJSCStringArg(JSContext* ctx, JSValueConst val) : ctx_(ctx), str_(JS_ToCStringLen(ctx, &len_, val)) {}
+    QJSCStringArg(QJSCStringArg&& o) noexcept : ctx_(o.ctx_), len_(o.len_), str_(std::exchange(o.str_, nullptr)) {}
+    QJSCStringArg(const QJSCStringArg&) = delete;
+    QJSCStringArg& operator=(const QJSCStringArg&) = delete;
+    ~QJSCStringArg() {
+        if (str_) JS_FreeCString(ctx_, str_);
+    }
+
+    operator std::string_view() const { return str_ ? std::string_view(str_, len_) : std::string_view(); }
+    operator const char*() const { return str_; }
+};
+
+template<typename T> struct QJSArgStorage { using type = T; };
+template<> struct QJSArgStorage<std::string_view> { using type = QJSCStringArg; };
+template<> struct QJSArgStorage<const char*> { using type = QJSCStringArg; };
+template<typename T> using qjs_arg_t = typename QJSArgStorage<T>::type;
+
+template<typename T>
+qjs_arg_t<T> qjs_arg(JSContext* ctx, JSValueConst val) {
+    if constexpr (std::is_same_v<qjs_arg_t<T>, QJSCStringArg>) return QJSCStringArg(ctx, val);
+    else return js_to_cpp<T>(ctx, val);
+}
+
+// Argument validation. Strict in QJS_NO_EXCEPTIONS mode (Wrapper / QJSAsync check every
+// argument, generated setters every field); elsewhere js_to_cpp keeps coercing.
+
+// What a parameter of type T expects, or nullptr when `val` fits. Follows the branches of
+// js_to_cpp; null / undefined stay valid wherever js_to_cpp maps them to an empty value,
+// except for structs passed by value.
+template<typename T>
+const char* qjs_arg_mismatch(JSContext* ctx, JSValueConst val) {
+    using BaseType = std::decay_t<std::remove_pointer_t<T>>;
+    const bool nullish = JS_IsNull(val) || JS_IsUndefined(val);
+
+    if constexpr (std::is_same_v<T, QJSCallback>) {
+        return nullptr;
+    }
+    else if constexpr (is_qjs_function_arg<T>::value) {
+        return nullish || JS_IsFunction(ctx, val) ? nullptr : "function";
+    }
+    else if constexpr (is_std_shared_ptr<T>::value) {
+        using E = std::remove_const_t<typename T::element_type>;
+        void* opaque = JSClassIdTraits<E>::id != 0 ? JS_GetOpaque(val, JSClassIdTraits<E>::id) : nullptr;
+        if (nullish) return nullptr;
+        if (opaque && std::is_copy_constructible_v<E>) return nullptr; // js_to_cpp copies it
+        if (QJSRef<E>* ref = opaque ? qjs_opaque_ref<E>(opaque) : nullptr; ref && ref->keep) return nullptr;
+        return qjs_type_name<E>().c_str();
+    }
+    else if constexpr (std::is_same_v<T, bool>) {
+        return JS_IsBool(val) || JS_IsNumber(val) ? nullptr : "boolean";
+    }
+    else if constexpr (std::is_integral_v<T>) {
+        return JS_IsNumber(val) || JS_IsBigInt(val) ? nullptr : "number";
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+        return JS_IsNumber(val) ? nullptr : "number";
+    }
+    else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+                       std::is_same_v<T, const char*>) {
+        return JS_IsString(val) ? nullptr : "string";
+    }
+    else if constexpr (std::is_enum_v<T>) {
+        return JS_IsNumber(val) ? nullptr : qjs_type_name<T>().c_str();
+    }
+    else if constexpr (is_qjs_buffer_view<T>::value || is_qjs_numeric_vector<T>::value ||
+                       is_qjs_numeric_array<T>::value
+#ifdef QJS_HAS_SPAN
+                       || is_std_span<T>::value
+#endif
+    ) {
+        using E = std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<T>().data())>>;
+        int type = JS_GetTypedArrayType(val);
+        if (type >= 0 ? qjs_typed_array_accepts<E>(type) : nullish || JS_IsArrayBuffer(val)) {
+            if (nullish) return nullptr;
+            // A detached buffer passes the type test but cannot be borrowed
+            if (qjs_buffer_view<const E>(ctx, val).data() || !JS_HasException(ctx)) return nullptr;
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            return "a buffer that is not detached";
+        }
+        if constexpr (is_qjs_numeric_vector<T>::value || is_qjs_numeric_array<T>::value) {
+            if (type >= 0 || JS_IsArray(val)) return nullptr; // converted element by element
+        }
+        return qjs_typed_array_name<E>();
+    }
+    // Containers: the shape only, elements are converted as they are
+    else if constexpr (is_std_vector<T>::value || is_std_array<T>::value || is_std_pair<T>::value) {
+        return nullish || JS_IsArray(val) ? nullptr : "Array";
+    }
+    else if constexpr (is_std_optional<T>::value) {
+        return nullish ? nullptr : qjs_arg_mismatch<typename T::value_type>(ctx, val);
+    }
+    else if constexpr (is_std_map<T>::value) {
+        return nullish || (JS_IsObject(val) && !JS_IsArray(val)) ? nullptr : "object";
+    }
+    else {
+        if constexpr (std::is_class_v<BaseType>) {
+            // Bound structs only; any other class is left to js_to_cpp
+            if (JSClassIdTraits<BaseType>::id != 0 || JSClassIdTraits<BaseType>::materialize) {
+                if (std::is_pointer_v<T> && nullish) return nullptr;
+                if (JSClassIdTraits<BaseType>::id != 0 && JS_GetOpaque(val, JSClassIdTraits<BaseType>::id)) return nullptr;
+                return qjs_type_name<BaseType>().c_str();
+            }
+        }
+        if constexpr (std::is_pointer_v<T>) {
+            return nullish || JS_IsString(val) || JS_IsNumber(val) || JS_IsBigInt(val) ? nullptr : "pointer";
+        }
+        return nullptr;
+    }
+}
+
+// Throws "arg <index> of <binding>: expected <type>". The binding name is only built here.
+template<typename T>
+bool qjs_check_arg(JSContext* ctx, JSValueConst val, int index, const std::string& (*binding)()) {
+    const char* expected = qjs_arg_mismatch<T>(ctx, val);
+    if (!expected) return true;
+    JS_ThrowTypeError(ctx, "arg %d of %s: expected %s", index, qjs_js_binding_name(binding()).c_str(), expected);
+    return false;
+}
+
+inline JSValue qjs_throw_arity(JSContext* ctx, const std::string& binding, int expected, int argc) {
+    return JS_ThrowTypeError(ctx, "%s: expected %d arguments, got %d", qjs_js_binding_name(binding).c_str(), expected,
+                             argc);
+}
+
+// [New] Overload matching (QJSOverloadSet, qjs_construct): a cheap tag test, stricter than
+// qjs_arg_mismatch for primitives so same-arity overloads stay apart. Integral parameters
+// take integral numbers only, floating ones any number, bool only booleans, strings only
+// strings; everything else (structs, containers, functions) defers to qjs_arg_mismatch.
+template<typename T>
+bool qjs_overload_accepts(JSContext* ctx, JSValueConst val) {
+    if constexpr (std::is_same_v<T, bool>) {
+        return JS_IsBool(val);
+    }
+    else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        switch (JS_VALUE_GET_NORM_TAG(val)) {
+            case JS_TAG_INT: return true;
+            case JS_TAG_FLOAT64: {
+                // Within the int64 range first: NaN and +-Inf fail both comparisons
+                double d = JS_VALUE_GET_FLOAT64(val);
+                return d >= -9223372036854775808.0 && d < 9223372036854775808.0 && d == std::trunc(d);
+            }
+            default: return sizeof(T) >= 8 && JS_IsBigInt(val);
+        }
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+        return JS_IsNumber(val);
+    }
+    else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+                       std::is_same_v<T, const char*>) {
+        return JS_IsString(val);
+    }
+    else {
+        return !qjs_arg_mismatch<T>(ctx, val);
+    }
+}
+
+// --- 5. Conversion: C++ -> JS ---
+
+// Strings carry their length: no strlen, embedded NULs survive. As non-templates these also
+// win over cpp_to_js<T>(T) for std::string arguments, so returned references and struct
+// fields are not copied first.
+inline JSValue cpp_to_js(JSContext* ctx, std::string_view val) { return JS_NewStringLen(ctx, val.data(), val.size()); }
+inline JSValue cpp_to_js(JSContext* ctx, const std::string& val) { return JS_NewStringLen(ctx, val.data(), val.size()); }
+
+// Wraps an object JS does not own (see QJSRef): borrowed when `keep` is empty, a view
+// into `owner` (which it keeps alive) when one is given.
+template<typename T>
+JSValue qjs_wrap_ref(JSContext* ctx, T* ptr, std::shared_ptr<T> keep, JSValueConst owner = JS_UNDEFINED) {
+    if (!ptr || JSClassIdTraits<T>::id == 0) return JS_NULL;
+    if (auto lazy = JSClassIdTraits<T>::materialize; lazy && lazy(ctx) < 0) return JS_EXCEPTION;
+    JSValue obj = JS_NewObjectClass(ctx, JSClassIdTraits<T>::id);
+    if (JS_IsException(obj)) return obj;
+    QJSRef<T>* ref = qjs_create<QJSRef<T>>(JS_GetRuntime(ctx),
+                                           QJSRef<T>{ptr, std::move(keep), JS_DupValue(ctx, owner)});
+    JS_SetOpaque(obj, reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(ref) | kQJSRefTag));
+    return obj;
+}
+
+template <typename T>
+JSValue cpp_to_js(JSContext* ctx, T val) {
+    using BaseType = std::decay_t<std::remove_pointer_t<T>>;
+
+    // Pointers JS must not delete: QJS_BORROWED results and shared_ptr results
+    if constexpr (is_qjs_borrowed<T>::value) {
+        using E = std::remove_const_t<std::remove_pointer_t<decltype(val.ptr)>>;
+        return qjs_wrap_ref<E>(ctx, const_cast<E*>(val.ptr), {});
+    }
+    else if constexpr (is_std_shared_ptr<T>::value) {
+        using E = std::remove_const_t<typename T::element_type>;
+        E* ptr = const_cast<E*>(val.get());
+        return qjs_wrap_ref<E>(ctx, ptr, std::const_pointer_cast<E>(std::move(val)));
+    }
+    // Buffers: vectors hand their storage to an ArrayBuffer, borrowed views are copied
+    else if constexpr (is_qjs_numeric_vector<T>::value) {
+        return qjs_typed_array_adopt(ctx, std::move(val));
+    }
+    else if constexpr (is_qjs_buffer_view<T>::value) {
+        using E = std::remove_cv_t<typename T::element_type>;
+        return qjs_typed_array_copy<E>(ctx, val.data(), val.size());
+    }
+#ifdef QJS_HAS_SPAN
+    else if constexpr (is_std_span<T>::value) {
+        using E = std::remove_cv_t<typename T::element_type>;
+        return qjs_typed_array_copy<E>(ctx, val.data(), val.size());
+    }
+#endif
+    else if constexpr (is_qjs_numeric_array<T>::value) {
+        return qjs_typed_array_copy<typename T::value_type>(ctx, val.data(), val.size());
+    }
+    // Containers of anything else (see section 4)
+    else if constexpr (is_std_vector<T>::value || is_std_array<T>::value) {
+        using E = typename T::value_type;
+        std::vector<JSValue> items;
+        items.reserve(val.size());
+        for (auto&& item : val) items.push_back(cpp_to_js(ctx, E(std::move(item))));
+        return qjs_new_array(ctx, items.data(), items.size());
+    }
+    else if constexpr (is_std_pair<T>::value) {
+        JSValue items[2] = {cpp_to_js(ctx, std::move(val.first)), cpp_to_js(ctx, std::move(val.second))};
+        return qjs_new_array(ctx, items, 2);
+    }
+    else if constexpr (is_std_optional<T>::value) {
+        return val ? cpp_to_js(ctx, std::move(*val)) : JS_NULL;
+    }
+    else if constexpr (is_std_map<T>::value) {
+        JSValue obj = JS_NewObject(ctx);
+        if (JS_IsException(obj)) return obj;
+        for (auto& [key, item] : val) {
+            JSValue k = cpp_to_js(ctx, key);
+            JSAtom atom = JS_IsException(k) ? JS_ATOM_NULL : JS_ValueToAtom(ctx, k);
+            JS_FreeValue(ctx, k);
+            JSValue v = cpp_to_js(ctx, std::move(item));
+            bool ok = atom != JS_ATOM_NULL && !JS_IsException(v);
+            if (ok) ok = JS_DefinePropertyValue(ctx, obj, atom, v, JS_PROP_C_W_E) >= 0;
+            else JS_FreeValue(ctx, v);
+            if (atom != JS_ATOM_NULL) JS_FreeAtom(ctx, atom);
+            if (!ok) {
+                JS_FreeValue(ctx, obj);
+                return JS_EXCEPTION;
+            }
+        }
+        return obj;
+    }
+
+    // Struct Value (T = Config)
+    if constexpr (!qjs_is_container_v<T> && !std::is_pointer_v<T> && !std::is_void_v<T> && !std::is_integral_v<T> && !std::is_floating_point_v<T> && !std::is_same_v<T, std::string> && !std::is_same_v<T, std::string_view> && !std::is_same_v<T, const char*> && !std::is_enum_v<T>) {
+        if (JSClassIdTraits<BaseType>::id != 0) {
+            if (auto lazy = JSClassIdTraits<BaseType>::materialize; lazy && lazy(ctx) < 0) return JS_EXCEPTION;
+            JSValue obj = JS_NewObjectClass(ctx, JSClassIdTraits<BaseType>::id);
+            if (JS_IsException(obj)) return obj;
+            BaseType* ptr = qjs_create<BaseType>(JS_GetRuntime(ctx), std::move(val));
+            JS_SetOpaque(obj, ptr);
+            return obj;
+        }
+    }
+
+    // Pointers (T = User*)
+    if constexpr (std::is_pointer_v<T>) {
+        if (val == nullptr) return JS_NULL;
+
+        // Struct Pointer: JS takes ownership (annotate the function QJS_BORROWED otherwise)
+        if (JSClassIdTraits<BaseType>::id != 0) {
+            assert((reinterpret_cast<uintptr_t>(val) & kQJSRefTag) == 0);
+            if (auto lazy = JSClassIdTraits<BaseType>::materialize; lazy && lazy(ctx) < 0) return JS_EXCEPTION;
+            JSValue obj = JS_NewObjectClass(ctx, JSClassIdTraits<BaseType>::id);
+            if (JS_IsException(obj)) return obj;
+            // [FIX] Cast away const because JS_SetOpaque takes void*
+            JS_SetOpaque(obj, const_cast<void*>(static_cast<const void*>(val)));
+            return obj;
+        }
+
+        // Generic Pointer -> BigInt
+        return JS_NewBigInt64(ctx, static_cast<int64_t>(reinterpret_cast<uintptr_t>(val)));
+    }
+
+    // Basic Types
+    if constexpr (std::is_void_v<T>) return JS_UNDEFINED;
+    else if constexpr (std::is_same_v<T, int> || std::is_same_v<T, int32_t>) return JS_NewInt32(ctx, val);
+    else if constexpr (std::is_same_v<T, uint32_t> || std::is_same_v<T, int64_t>) return JS_NewInt64(ctx, static_cast<int64_t>(val));
+    else if constexpr (std::is_floating_point_v<T>) return JS_NewFloat64(ctx, val);
+    else if constexpr (std::is_same_v<T, bool>) return JS_NewBool(ctx, val);
+    else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) return JS_NewStringLen(ctx, val.data(), val.size());
+    else if constexpr (std::is_same_v<T, const char*>) return JS_NewString(ctx, val ? val : "");
+    else if constexpr (std::is_enum_v<T>) return JS_NewInt32(ctx, static_cast<int32_t>(val));
+
+    return JS_NULL;
+}
+
+// --- 6. Wrapper Helper ---
+
+// Runs a bound call and turns what escapes it into a JS exception: C++ exceptions, or in
+// QJS_NO_EXCEPTIONS mode an exception a JS callback argument left pending (QJSCallbackScope).
+template<typename... Args, typename Body>
+JSValue qjs_call_boundary(JSContext* ctx, Body&& body) {
+#ifdef QJS_NO_EXCEPTIONS
+    if constexpr ((is_qjs_function_arg<std::decay_t<Args>>::value || ...)) {
+        QJSCallbackScope scope;
+        JSValue ret = body();
+        if (!scope.take_failure()) return ret;
+        JS_FreeValue(ctx, ret);
+        return JS_EXCEPTION;
+    } else {
+        return body();
+    }
+#else
+    try {
+        return body();
+    } catch (const QJSPendingException&) {
+        return JS_EXCEPTION;
+    } catch (...) {
+        return JS_ThrowInternalError(ctx, "C++ Exception");
+    }
+#endif
+}
+
+template<auto Func, typename F = decltype(Func)>
+struct Wrapper;
+
+template<auto Func, typename R, typename... Args>
+struct Wrapper<Func, R(*)(Args...)> {
+    template<std::size_t... Is>
+    static JSValue call_impl(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+#ifdef QJS_PROFILE_BINDING
+        static const uint32_t site = QJSProfiler::site(qjs_binding_name<Func>());
+        QJSProfileCounters& prof = QJSProfiler::local(site);
+        uint64_t t0 = QJSProfiler::now();
+        std::tuple<qjs_arg_t<std::decay_t<Args>>...> args{qjs_arg<std::decay_t<Args>>(ctx, argv[Is])...};
+        uint64_t t1 = QJSProfiler::now();
+        JSValue ret = JS_UNDEFINED;
+        uint64_t t2;
+        if constexpr (std::is_void_v<R>) {
+            Func(static_cast<Args&&>(std::get<Is>(args))...);
+            t2 = QJSProfiler::now();
+        } else {
+            R result = Func(static_cast<Args&&>(std::get<Is>(args))...);
+            t2 = QJSProfiler::now();
+            ret = cpp_to_js(ctx, static_cast<R&&>(result));
+        }
+        uint64_t t3 = QJSProfiler::now();
+        QJSProfileCounters::bump(prof.calls, 1);
+        QJSProfileCounters::bump(prof.args, t1 - t0);
+        QJSProfileCounters::bump(prof.native, t2 - t1);
+        QJSProfileCounters::bump(prof.ret, t3 - t2);
+        return ret;
+#else
+        if constexpr (std::is_void_v<R>) {
+            Func(qjs_arg<std::decay_t<Args>>(ctx, argv[Is])...);
+            return JS_UNDEFINED;
+        } else {
+            return cpp_to_js(ctx, Func(qjs_arg<std::decay_t<Args>>(ctx, argv[Is])...));
+        }
+#endif
+    }
+
+    template<std::size_t... Is>
+    static bool check_args(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+        return (qjs_check_arg<std::decay_t<Args>>(ctx, argv[Is], int(Is) + 1, &qjs_binding_name<Func>) && ...);
+    }
+
+    // Overload candidate interface (QJSOverloadSet)
+    static constexpr int arity = sizeof...(Args);
+
+    static const std::string& name() { return qjs_binding_name<Func>(); }
+
+    template<std::size_t... Is>
+    static bool accepts_impl(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+        return (qjs_overload_accepts<std::decay_t<Args>>(ctx, argv[Is]) && ...);
+    }
+
+    static bool accepts(JSContext* ctx, JSValueConst* argv) {
+        return accepts_impl(ctx, argv, std::make_index_sequence<sizeof...(Args)>{});
+    }
+
+    static JSValue call(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+        constexpr auto seq = std::make_index_sequence<sizeof...(Args)>{};
+        if (argc < (int)sizeof...(Args)) {
+            return qjs_throw_arity(ctx, qjs_binding_name<Func>(), (int)sizeof...(Args), argc);
+        }
+#ifdef QJS_NO_EXCEPTIONS
+        if (!check_args(ctx, argv, seq)) return JS_EXCEPTION;
+#endif
+        return qjs_call_boundary<Args...>(ctx, [&] { return call_impl(ctx, argv, seq); });
+    }
+
+    // --- Batch mode: name_batch(a, b, ..., [out]) ---
+    // Each argument is a TypedArray of the parameter's element type, or a number that is
+    // broadcast to every element. Func runs over the whole arrays in one native call and
+    // the results are written to `out` (a fresh TypedArray when omitted; in-place is fine).
+    // Only available when every parameter and the result map onto a TypedArray kind.
+    static constexpr bool batchable = sizeof...(Args) > 0 &&
+        (qjs_is_typed_element_v<std::decay_t<Args>> && ...) && (std::is_void_v<R> || qjs_is_typed_element_v<R>);
+
+    template<typename T>
+    struct BatchArg {
+        const T* ptr = nullptr;
+        T scalar{};
+        bool isArray = false;
+
+        T at(size_t i) const { return isArray ? ptr[i] : scalar; }
+    };
+
+    template<typename T>
+    static bool batch_arg(JSContext* ctx, JSValueConst val, int index, BatchArg<T>& arg, size_t& n, bool& haveArray) {
+        if (JS_IsNumber(val) || JS_IsBool(val) || JS_IsBigInt(val)) {
+            arg.scalar = js_to_cpp<T>(ctx, val);
+            return true;
+        }
+        int type = JS_GetTypedArrayType(val);
+        if (!(type >= 0 ? qjs_typed_array_accepts<T>(type) : JS_IsArrayBuffer(val))) {
+            JS_ThrowTypeError(ctx, "batch arg %d: expected a matching TypedArray or a number", index + 1);
+            return false;
+        }
+        QJSBufferView<const T> view = qjs_buffer_view<const T>(ctx, val);
+        if (!view.data() && JS_HasException(ctx)) return false; // detached
+        if (haveArray && view.size() != n) {
+            JS_ThrowRangeError(ctx, "batch arg %d: length %zu, expected %zu", index + 1, view.size(), n);
+            return false;
+        }
+        arg.ptr = view.data();
+        arg.isArray = true;
+        n = view.size();
+        haveArray = true;
+        return true;
+    }
+
+    // Contiguous loop when every input is an array (the common, vectorisable case),
+    // per-element broadcast otherwise.
+    template<typename Out, typename Tuple, std::size_t... Is>
+    static void batch_run(Out* out, size_t n, const Tuple& in, std::index_sequence<Is...>) {
+        if ((std::get<Is>(in).isArray && ...)) {
+            const auto ptrs = std::make_tuple(std::get<Is>(in).ptr...);
+            for (size_t i = 0; i < n; ++i) {
+                if constexpr (std::is_void_v<R>) Func(std::get<Is>(ptrs)[i]...);
+                else out[i] = Func(std::get<Is>(ptrs)[i]...);
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                if constexpr (std::is_void_v<R>) Func(std::get<Is>(in).at(i)...);
+                else out[i] = Func(std::get<Is>(in).at(i)...);
+            }
+        }
+    }
+
+    template<std::size_t... Is>
+    static JSValue call_batch_impl(JSContext* ctx, int argc, JSValueConst* argv, std::index_sequence<Is...> seq) {
+        constexpr int N = sizeof...(Args);
+        std::tuple<BatchArg<std::decay_t<Args>>...> in;
+        size_t n = 0;
+        bool haveArray = false;
+        if (!(batch_arg(ctx, argv[Is], (int)Is, std::get<Is>(in), n, haveArray) && ...)) return JS_EXCEPTION;
+        if (!haveArray) return JS_ThrowTypeError(ctx, "batch call needs at least one TypedArray");
+
+        if constexpr (std::is_void_v<R>) {
+            batch_run(static_cast<char*>(nullptr), n, in, seq);
+            return JS_UNDEFINED;
+        } else {
+            if (argc > N && !JS_IsUndefined(argv[N])) {
+                int type = JS_GetTypedArrayType(argv[N]);
+                QJSBufferView<R> out = qjs_buffer_view<R>(ctx, argv[N]);
+                if (type < 0 || !qjs_typed_array_accepts<R>(type))
+                    return JS_ThrowTypeError(ctx, "batch output: expected a TypedArray of the result type");
+                if (!out.data() && JS_HasException(ctx)) return JS_EXCEPTION; // detached
+                if (out.size() < n) return JS_ThrowRangeError(ctx, "batch output: length %zu, need %zu", out.size(), n);
+                batch_run(out.data(), n, in, seq);
+                return JS_DupValue(ctx, argv[N]);
+            }
+            std::vector<R> out(n);
+            batch_run(out.data(), n, in, seq);
+            return qjs_typed_array_adopt(ctx, std::move(out));
+        }
+    }
+
+    static JSValue call_batch(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+        static_assert(batchable, "call_batch needs arithmetic parameters and an arithmetic or void result");
+        if (argc < (int)sizeof...(Args)) {
+            return qjs_throw_arity(ctx, qjs_binding_name<Func>() + "_batch", (int)sizeof...(Args), argc);
+        }
+#ifdef QJS_NO_EXCEPTIONS
+        return call_batch_impl(ctx, argc, argv, std::make_index_sequence<sizeof...(Args)>{});
+#else
+        try {
+            return call_batch_impl(ctx, argc, argv, std::make_index_sequence<sizeof...(Args)>{});
+        } catch (...) {
+            return JS_ThrowInternalError(ctx, "C++ Exception");
+        }
+#endif
+    }
+};
+
+// noexcept functions bind like any other; only the function type differs.
+template<auto Func, typename R, typename... Args>
+struct Wrapper<Func, R(*)(Args...) noexcept> : Wrapper<Func, R(*)(Args...)> {};
+
+// [New] Member functions, registered on the class prototype. `this` is unwrapped once and the
+// method is called through the member pointer, without a free-function shim that takes the
+// object as a pointer argument. A returned reference to a bound struct (or a Borrowed
+// pointer) becomes a view that keeps `this` alive, like a nested field. Func may also be a
+// generated `R f(S& self, Args...)` adapter (a shorter form with default arguments).
+template<auto Func, bool Borrowed, typename S, typename R, typename... Args>
+struct QJSMethodImpl {
+    template<typename... A>
+    static R invoke(S* obj, A&&... args) {
+        if constexpr (std::is_member_function_pointer_v<decltype(Func)>) {
+            return (obj->*Func)(std::forward<A>(args)...);
+        } else {
+            return Func(*obj, std::forward<A>(args)...);
+        }
+    }
+
+    template<typename T>
+    static JSValue result_to_js(JSContext* ctx, JSValueConst self, T&& result) {
+        using E = std::remove_cv_t<std::remove_pointer_t<std::remove_reference_t<R>>>;
+        if constexpr (std::is_lvalue_reference_v<R> && std::is_class_v<E>) {
+            if (JSClassIdTraits<E>::id != 0) return qjs_wrap_ref<E>(ctx, const_cast<E*>(&result), {}, self);
+            return cpp_to_js(ctx, result);
+        } else if constexpr (Borrowed && std::is_pointer_v<R>) {
+            return qjs_wrap_ref<E>(ctx, const_cast<E*>(result), {}, self);
+        } else {
+            return cpp_to_js(ctx, std::forward<T>(result));
+        }
+    }
+
+    template<std::size_t... Is>
+    static JSValue call_impl(JSContext* ctx, JSValueConst self, S* obj, JSValueConst* argv,
+                             std::index_sequence<Is...>) {
+#ifdef QJS_PROFILE_BINDING
+        static const uint32_t site = QJSProfiler::site(qjs_binding_name<Func>());
+        QJSProfileCounters& prof = QJSProfiler::local(site);
+        uint64_t t0 = QJSProfiler::now();
+        std::tuple<qjs_arg_t<std::decay_t<Args>>...> args{qjs_arg<std::decay_t<Args>>(ctx, argv[Is])...};
+        uint64_t t1 = QJSProfiler::now();
+        JSValue ret = JS_UNDEFINED;
+        uint64_t t2;
+        if constexpr (std::is_void_v<R>) {
+            invoke(obj, static_cast<Args&&>(std::get<Is>(args))...);
+            t2 = QJSProfiler::now();
+        } else {
+            R result = invoke(obj, static_cast<Args&&>(std::get<Is>(args))...);
+            t2 = QJSProfiler::now();
+            ret = result_to_js(ctx, self, static_cast<R&&>(result));
+        }
+        uint64_t t3 = QJSProfiler::now();
+        QJSProfileCounters::bump(prof.calls, 1);
+        QJSProfileCounters::bump(prof.args, t1 - t0);
+        QJSProfileCounters::bump(prof.native, t2 - t1);
+        QJSProfileCounters::bump(prof.ret, t3 - t2);
+        return ret;
+#else
+        if constexpr (std::is_void_v<R>) {
+            invoke(obj, qjs_arg<std::decay_t<Args>>(ctx, argv[Is])...);
+            return JS_UNDEFINED;
+        } else {
+            return result_to_js(ctx, self, invoke(obj, qjs_arg<std::decay_t<Args>>(ctx, argv[Is])...));
+        }
+#endif
+    }
+
+    template<std::size_t... Is>
+    static bool check_args(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+        return (qjs_check_arg<std::decay_t<Args>>(ctx, argv[Is], int(Is) + 1, &qjs_binding_name<Func>) && ...);
+    }
+
+    static constexpr int arity = sizeof...(Args);
+
+    static const std::string& name() { return qjs_binding_name<Func>(); }
+
+    template<std::size_t... Is>
+    static bool accepts_impl(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+        return (qjs_overload_accepts<std::decay_t<Args>>(ctx, argv[Is]) && ...);
+    }
+
+    static bool accepts(JSContext* ctx, JSValueConst* argv) {
+        return accepts_impl(ctx, argv, std::make_index_sequence<sizeof...(Args)>{});
+    }
+
+    static JSValue call(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+        constexpr auto seq = std::make_index_sequence<sizeof...(Args)>{};
+        S* obj = qjs_unwrap<S>(this_val);
+        if (!obj) {
+            return JS_ThrowTypeError(ctx, "%s: `this` is not a %s", qjs_binding_name<Func>().c_str(),
+                                     qjs_type_name<S>().c_str());
+        }
+        if (argc < (int)sizeof...(Args)) {
+            return qjs_throw_arity(ctx, qjs_binding_name<Func>(), (int)sizeof...(Args), argc);
+        }
+#ifdef QJS_NO_EXCEPTIONS
+        if (!check_args(ctx, argv, seq)) return JS_EXCEPTION;
+#endif
+        return qjs_call_boundary<Args...>(ctx, [&] { return call_impl(ctx, this_val, obj, argv, seq); });
+    }
+};
+
+template<auto Func, bool Borrowed = false, typename M = decltype(Func)>
+struct QJSMethod;
+
+template<auto Func, bool Borrowed, typename S, typename R, typename... Args>
+struct QJSMethod<Func, Borrowed, R (S::*)(Args...)> : QJSMethodImpl<Func, Borrowed, S, R, Args...> {};
+template<auto Func, bool Borrowed, typename S, typename R, typename... Args>
+struct QJSMethod<Func, Borrowed, R (S::*)(Args...) const> : QJSMethodImpl<Func, Borrowed, S, R, Args...> {};
+template<auto Func, bool Borrowed, typename S, typename R, typename... Args>
+struct QJSMethod<Func, Borrowed, R (S::*)(Args...) noexcept> : QJSMethodImpl<Func, Borrowed, S, R, Args...> {};
+template<auto Func, bool Borrowed, typename S, typename R, typename... Args>
+struct QJSMethod<Func, Borrowed, R (S::*)(Args...) const noexcept> : QJSMethodImpl<Func, Borrowed, S, R, Args...> {};
+template<auto Func, bool Borrowed, typename S, typename R, typename... Args>
+struct QJSMethod<Func, Borrowed, R (*)(S&, Args...)> : QJSMethodImpl<Func, Borrowed, S, R, Args...> {};
+
+// [New] One JS function for same-named overloads: Wrapper / QJSMethod instantiations, most
+// specific first (the generator orders bool, integral, floating, string, then class and
+// other parameters). Candidates taking exactly argc arguments are tried first, then those
+// taking fewer, in order. Arity alone decides at compile time when no other candidate
+// shares it; otherwise the first candidate whose arguments pass qjs_overload_accepts wins.
+template<typename... Candidates>
+struct QJSOverloadSet {
+    template<int N>
+    static constexpr bool ambiguous = ((Candidates::arity == N) + ...) > 1;
+
+    static JSValue call(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+        JSValue ret = JS_UNDEFINED;
+        bool chosen = false;
+        auto attempt = [&](auto candidate, bool exact) {
+            using C = decltype(candidate);
+            if (chosen || (exact ? C::arity != argc : C::arity > argc)) return;
+            if constexpr (ambiguous<C::arity>) {
+                if (!C::accepts(ctx, argv)) return;
+            }
+            chosen = true;
+            ret = C::call(ctx, this_val, argc, argv);
+        };
+        (attempt(Candidates{}, true), ...);
+        (attempt(Candidates{}, false), ...);
+        if (chosen) return ret;
+        using First = std::tuple_element_t<0, std::tuple<Candidates...>>;
+        return JS_ThrowTypeError(ctx, "%s: no overload matches the arguments", qjs_js_binding_name(First::name()).c_str());
+    }
+};
+
+// [New] One declared constructor of a bound struct (its parameter types), for qjs_construct.
+template<typename... Args>
+struct QJSCtor {
+    static constexpr int arity = sizeof...(Args);
+
+    template<std::size_t... Is>
+    static bool accepts(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+        return (qjs_overload_accepts<std::decay_t<Args>>(ctx, argv[Is]) && ...);
+    }
+
+    template<typename S, std::size_t... Is>
+    static bool check_args(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+        return (qjs_check_arg<std::decay_t<Args>>(ctx, argv[Is], int(Is) + 1, &qjs_type_name<S>) && ...);
+    }
+
+    // Exact parameter types, so overload resolution picks this constructor
+    template<typename S, std::size_t... Is>
+    static S* create(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+        return qjs_create<S>(JS_GetRuntime(ctx), static_cast<Args>(qjs_arg<std::decay_t<Args>>(ctx, argv[Is]))...);
+    }
+};
+
+// [New] `new S(...)` for structs with declared constructors (most specific first, see
+// QJSOverloadSet): the first overload taking exactly argc arguments, else the first taking
+// fewer (extra arguments are ignored, as in JS). Only an arity shared by several overloads
+// tests argument types. Returns nullptr with a pending exception when nothing matches or the
+// constructor threw.
+template<typename S, typename... Ctors>
+S* qjs_construct(JSContext* ctx, int argc, JSValueConst* argv) {
+    constexpr bool overloaded = sizeof...(Ctors) > 1;
+    S* obj = nullptr;
+    bool chosen = false;
+    auto attempt = [&](auto ctor, bool exact) {
+        using C = decltype(ctor);
+        if (chosen || (exact ? C::arity != argc : C::arity > argc)) return;
+        constexpr auto seq = std::make_index_sequence<C::arity>{};
+        if constexpr (((Ctors::arity == C::arity) + ...) > 1) {
+            if (!C::accepts(ctx, argv, seq)) return;
+        }
+        chosen = true;
+#ifdef QJS_NO_EXCEPTIONS
+        if (!C::template check_args<S>(ctx, argv, seq)) return;
+#endif
+        obj = C::template create<S>(ctx, argv, seq);
+    };
+#ifdef QJS_NO_EXCEPTIONS
+    (attempt(Ctors{}, true), ...);
+    (attempt(Ctors{}, false), ...);
+#else
+    try {
+        (attempt(Ctors{}, true), ...);
+        (attempt(Ctors{}, false), ...);
+    } catch (const QJSPendingException&) {
+        return nullptr;
+    } catch (...) {
+        JS_ThrowInternalError(ctx, "C++ Exception");
+        return nullptr;
+    }
+#endif
+    if (!chosen) {
+        if constexpr (overloaded) {
+            JS_ThrowTypeError(ctx, "%s: no constructor matches the arguments", qjs_type_name<S>().c_str());
+        } else {
+            qjs_throw_arity(ctx, qjs_type_name<S>(), (Ctors::arity + ...), argc);
+        }
+    }
+    return obj;
+}
+
+// --- 7. Binary Struct Layout (toBuffer / fromBuffer) ---
+// Structs are written field by field over their bound members: arithmetic and enum members
+// as raw bytes, std::string as a uint32 length followed by its bytes, std::array element by
+// element. Host byte order, meant for round trips within the same build. Pointers, nested
+// structs and other members are skipped on both sides, so a buffer cannot forge an address
+// and toBuffer never exposes padding or unbound members. A bool byte other than 0 / 1 makes
+// the buffer malformed.
+
+template<typename T>
+struct qjs_binary_field : std::bool_constant<std::is_same_v<T, std::string> || std::is_arithmetic_v<T> ||
+                                             std::is_enum_v<T>> {};
+template<typename T, size_t N>
+struct qjs_binary_field<std::array<T, N>> : qjs_binary_field<T> {};
+template<typename T>
+inline constexpr bool qjs_binary_field_v = qjs_binary_field<T>::value;
+
+// [New] True when S is nothing but its bound fields laid end to end: non-bool arithmetic
+// members, no padding, and no base, private or unbound member taking up bytes (their sizes
+// would not add up). Such a struct is copied byte-for-byte, which gives the same bytes as
+// the field-wise layout, and every bit pattern is a valid value of every member.
+template<typename S, typename... F>
+inline constexpr bool qjs_raw_layout_v =
+    std::is_trivially_copyable_v<S> && sizeof...(F) > 0 &&
+    ((std::is_arithmetic_v<F> && !std::is_same_v<F, bool>) && ...) && (sizeof(F) + ... + 0) == sizeof(S);
+
+class QJSBinaryWriter {
+    std::vector<uint8_t> bytes_;
+
+public:
+    template<typename T>
+    void put(const T& v) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            put(static_cast<uint32_t>(v.size()));
+            bytes_.insert(bytes_.end(), v.begin(), v.end());
+        } else if constexpr (is_std_array<T>::value) {
+            if constexpr (qjs_binary_field_v<T>) for (const auto& e : v) put(e);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            bytes_.push_back(v ? 1 : 0);
+        } else if constexpr (qjs_binary_field_v<T>) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+            bytes_.insert(bytes_.end(), p, p + sizeof(T));
+        }
+    }
+
+    // Hands the bytes to a new ArrayBuffer without copying.
+    JSValue finish(JSContext* ctx) {
+        if (bytes_.empty()) return JS_NewArrayBufferCopy(ctx, reinterpret_cast<const uint8_t*>(""), 0);
+        auto* owned = new std::vector<uint8_t>(std::move(bytes_));
+        JSFreeArrayBufferDataFunc* free_func = [](JSRuntime*, void* opaque, void*) {
+            delete static_cast<std::vector<uint8_t>*>(opaque);
+        };
+        return JS_NewArrayBuffer(ctx, owned->data(), owned->size(), free_func, owned, false);
+    }
+};
+
+class QJSBinaryReader {
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool ok_ = true;
+
+    bool take(void* dst, size_t n) {
+        if (!ok_ || static_cast<size_t>(end_ - p_) < n) return ok_ = false;
+        std::memcpy(dst, p_, n);
+        p_ += n;
+        return true;
+    }
+
+public:
+    QJSBinaryReader(const uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+    template<typename T>
+    void get(T& v) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            uint32_t n = 0;
+            if (!take(&n, sizeof(n))) return;
+            if (static_cast<size_t>(end_ - p_) < n) {
+                ok_ = false;
+                return;
+            }
+            v.assign(reinterpret_cast<const char*>(p_), n);
+            p_ += n;
+        } else if constexpr (is_std_array<T>::value) {
+            if constexpr (qjs_binary_field_v<T>) for (auto& e : v) get(e);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            uint8_t b = 0; // never materialise a bool from an arbitrary byte
+            if (take(&b, 1)) {
+                if (b > 1) ok_ = false;
+                else v = b != 0;
+            }
+        } else if constexpr (std::is_enum_v<T>) {
+            std::underlying_type_t<T> u{};
+            if (take(&u, sizeof(u))) v = static_cast<T>(u);
+        } else if constexpr (qjs_binary_field_v<T>) {
+            take(static_cast<void*>(&v), sizeof(T));
+        }
+    }
+
+    // True when every field was read and the buffer is fully consumed.
+    bool ok() const { return ok_ && p_ == end_; }
+};
+
+// `fields` is a generic lambda that calls w.put(obj.member) for each bound member. Raw is
+// qjs_raw_layout_v over the bound member types.
+template<bool Raw, typename S, typename Fields>
+JSValue qjs_struct_to_buffer(JSContext* ctx, const S& obj, Fields&& fields) {
+    if constexpr (Raw) {
+        return JS_NewArrayBufferCopy(ctx, reinterpret_cast<const uint8_t*>(&obj), sizeof(S));
+    } else {
+        QJSBinaryWriter w;
+        fields(w);
+        return w.finish(ctx);
+    }
+}
+
+// `fields` calls r.get(obj.member) in the same order. Returns false on a size mismatch or
+// an invalid bool byte.
+template<bool Raw, typename S, typename Fields>
+bool qjs_struct_from_buffer(QJSBufferView<const uint8_t> buf, S& obj, Fields&& fields) {
+    if constexpr (Raw) {
+        if (buf.size() != sizeof(S)) return false;
+        std::memcpy(static_cast<void*>(&obj), buf.data(), sizeof(S));
+        return true;
+    } else {
+        QJSBinaryReader r(buf.data(), buf.size());
+        fields(r);
+        return r.ok();
+    }
+}
+
+// --- 8. Module Templates ---
+// A module template runs a generated module init once per runtime, in a private
+// context, and keeps the resulting exports and class prototypes. Later contexts on the
+// runtime attach the module by re-exporting those values: no class registration, no
+// prototype function lists, no enum objects are rebuilt.
+//
+// The cached values belong to the template context. Bound functions therefore execute
+// in its realm (objects they return inherit from the template's Object.prototype), and
+// the exports and prototypes are shared, so changes a script makes to them are visible
+// in every context that attached the module.
+
+struct QJSModuleTemplate : QJSRuntimeSlot {
+    JSContext* ctx = nullptr; // private context the module was built in
+    std::vector<std::pair<std::string, JSValue>> exports;
+    std::vector<std::pair<JSClassID, JSValue>> protos;
+
+    void release() {
+        if (!ctx) return;
+        for (auto& e : exports) JS_FreeValue(ctx, e.second);
+        for (auto& p : protos) JS_FreeValue(ctx, p.second);
+        exports.clear();
+        protos.clear();
+        JS_FreeContext(ctx);
+        ctx = nullptr;
+    }
+    ~QJSModuleTemplate() override { release(); }
+};
+
+template<typename Tag>
+struct QJSModuleTemplateSlot : QJSModuleTemplate {};
+
+using QJSModuleInit = JSModuleDef* (*)(JSContext*, const char*);
+
+// Builds `t` in a fresh context of `rt`: runs `init`, evaluates the module so its init
+// callback fills the exports, then captures the namespace and every class prototype.
+inline bool qjs_build_module_template(JSRuntime* rt, QJSModuleTemplate& t, const char* name, QJSModuleInit init) {
+    JSContext* ctx = JS_NewContext(rt);
+    if (!ctx) return false;
+    t.ctx = ctx;
+
+    std::vector<QJSClassRecord> classes;
+    qjs_class_recorder() = &classes;
+    bool ok = init(ctx, name) != nullptr;
+    if (ok) {
+        std::string src = std::string("import * as ns from '") + name + "';\nglobalThis.__qjs_template_ns = ns;\n";
+        JSValue r = JS_Eval(ctx, src.c_str(), src.size(), "<qjs-module-template>", JS_EVAL_TYPE_MODULE);
+        ok = !JS_IsException(r);
+        JS_FreeValue(ctx, r);
+    }
+    qjs_class_recorder() = nullptr;
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue ns = ok ? JS_GetPropertyStr(ctx, global, "__qjs_template_ns") : JS_UNDEFINED;
+    JS_FreeValue(ctx, global);
+    JSPropertyEnum* names = nullptr;
+    uint32_t count = 0;
+    ok = ok && JS_IsObject(ns) &&
+        JS_GetOwnPropertyNames(ctx, &names, &count, ns, JS_GPN_STRING_MASK | JS_GPN_ENUM_ONLY) == 0;
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        const char* key = JS_AtomToCString(ctx, names[i].atom);
+        if (key) t.exports.emplace_back(key, JS_GetProperty(ctx, ns, names[i].atom));
+        JS_FreeCString(ctx, key);
+    }
+    if (names) JS_FreePropertyEnum(ctx, names, count);
+    JS_FreeValue(ctx, ns);
+
+    for (const auto& c : classes) {
+        if (!ok) break;
+        ok = c.materialize(ctx) == 0;
+        if (ok) t.protos.emplace_back(c.id, JS_GetClassProto(ctx, c.id));
+    }
+    if (!ok) {
+        JSValue exc = JS_GetException(ctx);
+        JS_FreeValue(ctx, exc);
+        t.release();
+    }
+    return ok;
+}
+
+// Registers module `name` in `ctx` from the runtime's template, building the template on
+// the first call. Same contract as the generated js_init_module_<name>.
+template<typename Tag>
+JSModuleDef* qjs_attach_module_template(JSContext* ctx, const char* name, QJSModuleInit init) {
+    JSRuntime* rt = JS_GetRuntime(ctx);
+    auto& t = QJSRuntimeState::get(rt).slot<QJSModuleTemplateSlot<Tag>>();
+    if (!t.ctx && !qjs_build_module_template(rt, t, name, init)) {
+        JS_ThrowInternalError(ctx, "failed to build the binding template for module '%s'", name);
+        return nullptr;
+    }
+    JSModuleDef* m = JS_NewCModule(ctx, name, [](JSContext* ctx, JSModuleDef* m) {
+        auto* t = QJSRuntimeState::get(JS_GetRuntime(ctx)).find_slot<QJSModuleTemplateSlot<Tag>>();
+        if (!t || !t->ctx) return -1;
+        for (const auto& p : t->protos) JS_SetClassProto(ctx, p.first, JS_DupValue(ctx, p.second));
+        for (const auto& e : t->exports) {
+            if (JS_SetModuleExport(ctx, m, e.first.c_str(), JS_DupValue(ctx, e.second)) != 0) return -1;
+        }
+        return 0;
+    });
+    if (!m) return nullptr;
+    for (const auto& e : t.exports) JS_AddModuleExport(ctx, m, e.first.c_str());
+    return m;
+}
+
+// Drops the template of `rt`. Call it before JS_FreeRuntime: the template context must be
+// gone before the runtime checks for leaked objects.
+template<typename Tag>
+void qjs_release_module_template(JSRuntime* rt) {
+    if (QJSRuntimeState* state = QJSRuntimeState::find(rt)) {
+        if (auto* t = state->find_slot<QJSModuleTemplateSlot<Tag>>()) t->release();
+    }
+}
+
+// --- 9. Async Calls (QJS_ASYNC) ---
+// QJSAsync<Func>::call converts the arguments into owned C++ values on the JS thread,
+// runs Func on a bounded worker pool and returns a Promise. Workers never touch the JS
+// runtime: they post the finished result to the runtime's channel, and the promise is
+// settled on the JS thread when the host pumps it, either with qjs_async_poll() from its
+// own loop, or automatically inside js_std_loop after qjs_async_attach_std_loop().
+// Hosts call qjs_async_release(rt) before JS_FreeRuntime: it waits for the calls still
+// running and frees the JS values they hold while the runtime is intact.
+//
+// Argument rules: `const char*` and std::string_view are copied into a std::string; struct pointers keep their
+// JS object alive until the call settles (the object must tolerate access from the
+// worker); callbacks and borrowed buffer views cannot outlive the call and are rejected
+// at compile time.
+
+struct QJSAsyncConfig {
+    size_t threads = 0;       // 0: std::thread::hardware_concurrency()
+    size_t max_queued = 1024; // calls beyond this are rejected with a RangeError
+};
+
+// Takes effect if changed before the first async call.
+inline QJSAsyncConfig& qjs_async_config() {
+    static QJSAsyncConfig config;
+    return config;
+}
+
+class QJSThreadPool {
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> queue_;
+    std::vector<std::thread> workers_;
+    size_t max_queued_;
+    bool stop_ = false;
+
+public:
+    QJSThreadPool(size_t threads, size_t max_queued) : max_queued_(max_queued) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] {
+                for (;;) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mu_);
+                        cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                        if (queue_.empty()) return;
+                        task = std::move(queue_.front());
+                        queue_.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+    ~QJSThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+    // False when the queue is full.
+    bool submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (queue_.size() >= max_queued_) return false;
+            queue_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+        return true;
+    }
+};
+
+inline QJSThreadPool& qjs_async_pool() {
+    static QJSThreadPool pool(qjs_async_config().threads, qjs_async_config().max_queued);
+    return pool;
+}
+
+// Outcome of one call, produced on a worker. `settle` builds the JS value on the JS thread.
+struct QJSAsyncResult {
+    std::function<JSValue(JSContext*)> settle;
+    std::string error; // non-empty: the native call threw
+};
+
+// Worker -> JS thread hand-off. Shared with the workers, so a result that arrives after
+// the runtime state is gone is simply dropped.
+struct QJSAsyncChannel {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::vector<std::pair<uint64_t, QJSAsyncResult>> done;
+    std::vector<std::function<void()>> tasks; // run on the JS thread (queued callbacks, releases)
+    int wake_fd = -1; // write end of the js_std_loop self-pipe
+    bool closed = false; // the runtime is gone
+
+    void wake_locked() {
+#ifndef _WIN32
+        if (wake_fd >= 0) {
+            char byte = 1;
+            (void)!write(wake_fd, &byte, 1);
+        }
+#endif
+    }
+
+    void complete(uint64_t id, QJSAsyncResult result) {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            done.emplace_back(id, std::move(result));
+            wake_locked();
+        }
+        cv.notify_all();
+    }
+
+    // Runs `task` on the JS thread at the next poll. False once the runtime is gone.
+    bool post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if (closed) return false;
+            tasks.push_back(std::move(task));
+            wake_locked();
+        }
+        cv.notify_all();
+        return true;
+    }
+};
+
+// JS-thread side of a runtime's async calls.
+struct QJSAsyncState : QJSRuntimeSlot {
+    struct Pending {
+        JSContext* ctx;        // context the promise belongs to (ref held)
+        JSValue funcs[2];      // resolve, reject
+        std::vector<JSValue> keep; // struct arguments kept alive for the worker
+    };
+
+    JSRuntime* rt = nullptr;
+    std::shared_ptr<QJSAsyncChannel> channel = std::make_shared<QJSAsyncChannel>();
+    std::unordered_map<uint64_t, Pending> pending;
+    uint64_t next_id = 1;
+    size_t listeners = 0; // queued callbacks that may still receive events (section 10)
+    // js_std_loop integration (qjs_async_attach_std_loop)
+    int read_fd = -1;
+    int wake_write_fd = -1;
+    JSContext* watch_ctx = nullptr;
+    JSValue watch = JS_UNDEFINED; // (on) => os.setReadHandler(read_fd, on ? poll : null)
+
+    void set_watch(bool on) {
+        if (!watch_ctx) return;
+        JSValue arg = JS_NewBool(watch_ctx, on);
+        JS_FreeValue(watch_ctx, JS_Call(watch_ctx, watch, JS_UNDEFINED, 1, &arg));
+    }
+
+    // js_std_loop keeps watching while a promise is pending or a listener is registered.
+    bool busy() const { return !pending.empty() || listeners > 0; }
+    void add_listener() {
+        if (!busy()) set_watch(true);
+        listeners++;
+    }
+    void remove_listener() {
+        if (--listeners == 0 && !busy()) set_watch(false);
+    }
+
+    void drop(Pending& p) {
+        JS_FreeValueRT(rt, p.funcs[0]);
+        JS_FreeValueRT(rt, p.funcs[1]);
+        for (JSValue v : p.keep) JS_FreeValueRT(rt, v);
+        JS_FreeContext(p.ctx);
+    }
+
+    // Runs from the runtime finalizer, when the runtime's objects are already gone: JS values
+    // are released by qjs_async_release beforehand, anything still pending here is leaked.
+    ~QJSAsyncState() override {
+        std::vector<std::function<void()>> orphaned;
+        {
+            std::lock_guard<std::mutex> lock(channel->mu);
+            channel->wake_fd = -1;
+            channel->closed = true;
+            orphaned.swap(channel->tasks);
+        }
+        orphaned.clear(); // may release callback references, which now skip the runtime
+#ifndef _WIN32
+        if (read_fd >= 0) close(read_fd);
+        if (wake_write_fd >= 0) close(wake_write_fd);
+#endif
+    }
+};
+
+inline QJSAsyncState& qjs_async_state(JSRuntime* rt) {
+    QJSAsyncState& st = QJSRuntimeState::get(rt).slot<QJSAsyncState>();
+    st.rt = rt;
+    return st;
+}
+
+// Number of calls on `rt` that have not settled yet.
+inline size_t qjs_async_pending(JSRuntime* rt) {
+    QJSRuntimeState* state = QJSRuntimeState::find(rt);
+    QJSAsyncState* st = state ? state->find_slot<QJSAsyncState>() : nullptr;
+    return st ? st->pending.size() : 0;
+}
+
+// Settles every finished call of the context's runtime and runs queued callback batches.
+// Returns how many calls and batches were handled.
+inline size_t qjs_async_poll(JSContext* ctx) {
+    QJSRuntimeState* state = QJSRuntimeState::find(JS_GetRuntime(ctx));
+    QJSAsyncState* st = state ? state->find_slot<QJSAsyncState>() : nullptr;
+    if (!st) return 0;
+    std::vector<std::pair<uint64_t, QJSAsyncResult>> done;
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(st->channel->mu);
+        done.swap(st->channel->done);
+        tasks.swap(st->channel->tasks);
+#ifndef _WIN32
+        char buf[64];
+        if (st->read_fd >= 0) while (read(st->read_fd, buf, sizeof(buf)) > 0) {}
+#endif
+    }
+    for (auto& [id, result] : done) {
+        auto it = st->pending.find(id);
+        if (it == st->pending.end()) continue;
+        QJSAsyncState::Pending p = std::move(it->second);
+        st->pending.erase(it);
+        JSContext* c = p.ctx;
+        JSValue value;
+        bool ok = result.error.empty();
+        if (ok) {
+            value = result.settle(c);
+            if (JS_IsException(value)) {
+                ok = false;
+                value = JS_GetException(c);
+            }
+        } else {
+            value = JS_NewError(c);
+            JS_SetPropertyStr(c, value, "message", JS_NewString(c, result.error.c_str()));
+        }
+        JS_FreeValue(c, JS_Call(c, p.funcs[ok ? 0 : 1], JS_UNDEFINED, 1, &value));
+        JS_FreeValue(c, value);
+        st->drop(p);
+        if (!st->busy()) st->set_watch(false);
+    }
+    for (auto& task : tasks) task();
+    return done.size() + tasks.size();
+}
+
+// Blocks until a call of `rt` has finished (or a queued callback has events) or
+// `timeout_ms` passed (< 0: no timeout).
+inline void qjs_async_wait(JSRuntime* rt, int timeout_ms = -1) {
+    QJSRuntimeState* state = QJSRuntimeState::find(rt);
+    QJSAsyncState* st = state ? state->find_slot<QJSAsyncState>() : nullptr;
+    if (!st || !st->busy()) return;
+    std::unique_lock<std::mutex> lock(st->channel->mu);
+    auto ready = [&] { return !st->channel->done.empty() || !st->channel->tasks.empty(); };
+    if (timeout_ms < 0) st->channel->cv.wait(lock, ready);
+    else st->channel->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+}
+
+// Shutdown of `rt`'s async calls; call it before JS_FreeRuntime (and before freeing a
+// context that called qjs_async_attach_std_loop). Waits until every running call has
+// finished, so no worker still uses a struct argument, then drops their promises unsettled
+// and frees the values they kept alive.
+inline void qjs_async_release(JSRuntime* rt) {
+    QJSRuntimeState* state = QJSRuntimeState::find(rt);
+    QJSAsyncState* st = state ? state->find_slot<QJSAsyncState>() : nullptr;
+    if (!st) return;
+    {
+        // Results only ever come from pending calls
+        std::unique_lock<std::mutex> lock(st->channel->mu);
+        st->channel->cv.wait(lock, [st] { return st->channel->done.size() >= st->pending.size(); });
+        st->channel->done.clear();
+    }
+    for (auto& p : st->pending) st->drop(p.second);
+    st->pending.clear();
+    if (st->watch_ctx) {
+        {
+            std::lock_guard<std::mutex> lock(st->channel->mu);
+            st->channel->wake_fd = -1;
+        }
+        JS_FreeValueRT(rt, st->watch);
+        st->watch = JS_UNDEFINED;
+        st->watch_ctx = nullptr;
+#ifndef _WIN32
+        close(st->read_fd);
+        close(st->wake_write_fd);
+        st->read_fd = st->wake_write_fd = -1;
+#endif
+    }
+}
+
+// Lets js_std_loop settle async calls: a self-pipe is registered with os.setReadHandler
+// while calls are pending, so the loop stays alive and wakes up as results arrive. The
+// 'os' module must be importable in `ctx` (js_init_module_os). Returns 0 on success.
+inline int qjs_async_attach_std_loop(JSContext* ctx) {
+#ifdef _WIN32
+    (void)ctx;
+    return -1;
+#else
+    QJSAsyncState& st = qjs_async_state(JS_GetRuntime(ctx));
+    if (st.watch_ctx) return 0;
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    JS_SetPropertyStr(ctx, global, "__qjs_async_poll", JS_NewCFunction(ctx, [](JSContext* c, JSValueConst, int, JSValueConst*) {
+        qjs_async_poll(c);
+        return JS_UNDEFINED;
+    }, "__qjs_async_poll", 0));
+    std::string src = "import * as os from 'os';\n"
+        "globalThis.__qjs_async_watch = (on) => os.setReadHandler(" + std::to_string(fds[0]) +
+        ", on ? globalThis.__qjs_async_poll : null);\n";
+    JSValue r = JS_Eval(ctx, src.c_str(), src.size(), "<qjs-async>", JS_EVAL_TYPE_MODULE);
+    bool ok = !JS_IsException(r);
+    JS_FreeValue(ctx, r);
+    JSValue watch = ok ? JS_GetPropertyStr(ctx, global, "__qjs_async_watch") : JS_UNDEFINED;
+    JS_FreeValue(ctx, global);
+    if (!JS_IsFunction(ctx, watch)) {
+        JS_FreeValue(ctx, watch);
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    st.read_fd = fds[0];
+    st.wake_write_fd = fds[1];
+    st.watch = watch;
+    st.watch_ctx = ctx;
+    {
+        std::lock_guard<std::mutex> lock(st.channel->mu);
+        st.channel->wake_fd = fds[1];
+    }
+    if (st.busy()) st.set_watch(true);
+    return 0;
+#endif
+}
+
+// Owned storage for an argument while the call is in flight.
+template<typename T> struct QJSAsyncOwned { using type = std::decay_t<T>; };
+template<> struct QJSAsyncOwned<const char*> { using type = std::string; };
+template<> struct QJSAsyncOwned<std::string_view> { using type = std::string; };
+
+template<typename T>
+decltype(auto) qjs_async_pass(typename QJSAsyncOwned<std::decay_t<T>>::type& v) {
+    if constexpr (std::is_same_v<std::decay_t<T>, const char*>) return v.c_str();
+    else if constexpr (std::is_same_v<std::decay_t<T>, std::string_view>) return std::string_view(v);
+    else return static_cast<T&&>(v);
+}
+
+template<auto Func, typename F = decltype(Func)>
+struct QJSAsync;
+
+template<auto Func, typename R, typename... Args>
+struct QJSAsync<Func, R(*)(Args...)> {
+    static_assert(((!std::is_same_v<std::decay_t<Args>, QJSCallback> && !is_qjs_function_arg<std::decay_t<Args>>::value &&
+                    !is_qjs_buffer_view<std::decay_t<Args>>::value) && ...),
+                  "QJS_ASYNC: callbacks and buffer views cannot outlive the JS call");
+#ifdef QJS_HAS_SPAN
+    static_assert((!is_std_span<std::decay_t<Args>>::value && ...), "QJS_ASYNC: spans cannot outlive the JS call");
+#endif
+
+    using Stored = std::tuple<typename QJSAsyncOwned<std::decay_t<Args>>::type...>;
+
+    template<std::size_t... Is>
+    static Stored convert(JSContext* ctx, JSValueConst* argv, std::vector<JSValue>& keep, std::index_sequence<Is...>) {
+        // Struct pointers stay valid while their JS object does
+        ((std::is_pointer_v<std::decay_t<Args>> && JS_IsObject(argv[Is]) ? keep.push_back(JS_DupValue(ctx, argv[Is]))
+                                                                           : void()), ...);
+        return Stored{js_to_cpp<typename QJSAsyncOwned<std::decay_t<Args>>::type>(ctx, argv[Is])...};
+    }
+
+    template<std::size_t... Is>
+    static QJSAsyncResult run(Stored& args, std::index_sequence<Is...>) {
+        QJSAsyncResult result;
+#ifndef QJS_NO_EXCEPTIONS
+        try {
+#endif
+            if constexpr (std::is_void_v<R>) {
+                Func(qjs_async_pass<Args>(std::get<Is>(args))...);
+                result.settle = [](JSContext*) { return JS_UNDEFINED; };
+            } else {
+                // Owned copy: a returned view may point into the arguments, gone before settling
+                auto value = std::make_shared<typename QJSAsyncOwned<std::decay_t<R>>::type>(
+                    Func(qjs_async_pass<Args>(std::get<Is>(args))...));
+                result.settle = [value](JSContext* ctx) { return cpp_to_js(ctx, std::move(*value)); };
+            }
+#ifndef QJS_NO_EXCEPTIONS
+        } catch (const std::exception& e) {
+            result.error = e.what()[0] ? e.what() : "C++ Exception";
+        } catch (...) {
+            result.error = "C++ Exception";
+        }
+#endif
+        return result;
+    }
+
+    template<std::size_t... Is>
+    static bool check_args(JSContext* ctx, JSValueConst* argv, std::index_sequence<Is...>) {
+        return (qjs_check_arg<std::decay_t<Args>>(ctx, argv[Is], int(Is) + 1, &qjs_binding_name<Func>) && ...);
+    }
+
+    static JSValue call(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+        constexpr size_t N = sizeof...(Args);
+        if (argc < (int)N) return qjs_throw_arity(ctx, qjs_binding_name<Func>() + "_async", (int)N, argc);
+        QJSAsyncState& st = qjs_async_state(JS_GetRuntime(ctx));
+
+        QJSAsyncState::Pending p{ctx, {JS_UNDEFINED, JS_UNDEFINED}, {}};
+        std::shared_ptr<Stored> args;
+#ifdef QJS_NO_EXCEPTIONS
+        if (!check_args(ctx, argv, std::make_index_sequence<N>{})) return JS_EXCEPTION;
+        args = std::make_shared<Stored>(convert(ctx, argv, p.keep, std::make_index_sequence<N>{}));
+#else
+        try {
+            args = std::make_shared<Stored>(convert(ctx, argv, p.keep, std::make_index_sequence<N>{}));
+        } catch (const QJSPendingException&) {
+            for (JSValue v : p.keep) JS_FreeValue(ctx, v);
+            return JS_EXCEPTION;
+        } catch (...) {
+            for (JSValue v : p.keep) JS_FreeValue(ctx, v);
+            return JS_ThrowInternalError(ctx, "C++ Exception");
+        }
+#endif
+        JSValue promise = JS_NewPromiseCapability(ctx, p.funcs);
+        if (JS_IsException(promise)) {
+            for (JSValue v : p.keep) JS_FreeValue(ctx, v);
+            return promise;
+        }
+
+        uint64_t id = st.next_id++;
+        std::shared_ptr<QJSAsyncChannel> channel = st.channel;
+        bool queued = qjs_async_pool().submit([channel, id, args] {
+            channel->complete(id, run(*args, std::make_index_sequence<N>{}));
+        });
+        if (!queued) {
+            JS_ThrowRangeError(ctx, "async queue full (%zu calls)", qjs_async_config().max_queued);
+            JSValue exc = JS_GetException(ctx);
+            JS_FreeValue(ctx, JS_Call(ctx, p.funcs[1], JS_UNDEFINED, 1, &exc));
+            JS_FreeValue(ctx, exc);
+            JS_FreeValue(ctx, p.funcs[0]);
+            JS_FreeValue(ctx, p.funcs[1]);
+            for (JSValue v : p.keep) JS_FreeValue(ctx, v);
+            return promise;
+        }
+        p.ctx = JS_DupContext(ctx);
+        bool idle = !st.busy();
+        st.pending.emplace(id, std::move(p));
+        if (idle) st.set_watch(true);
+        return promise;
+    }
+};
+
+template<auto Func, typename R, typename... Args>
+struct QJSAsync<Func, R(*)(Args...) noexcept> : QJSAsync<Func, R(*)(Args...)> {};
+
+// --- 10. Callbacks ---
+// JS functions handed to native code as std::function<Sig>, QJSFunction<Sig>,
+// QJSQueuedFunction<Sig> or, through generated trampolines, as a C function pointer plus
+// its `void* user_data` (QJSCallbackArg). The function is duplicated into a QJSFunctionRef
+// and freed when the last copy goes away; a copy dropped on another thread hands the
+// release to the JS thread through the runtime's async channel (section 9).
+//
+// Direct callbacks must be invoked on the JS thread. Queued callbacks (QJS_QUEUED) may be
+// invoked from any thread: a call only appends an event, and the JS thread delivers every
+// pending event in one call, fn([[...args], [...args], ...]), at its next qjs_async_poll()
+// (or inside js_std_loop after qjs_async_attach_std_loop). A registered queued callback
+// keeps js_std_loop alive until it is released.
+//
+// A direct C callback lives for the bound call only. Native code that keeps it (a handler
+// set with set_handler(cb, ud), one add_event_cb per object) needs QJS_RETAINED; retained
+// and queued registrations stay alive, every one native code may still hold, until JS
+// passes null through the same parameter. Hosts call qjs_callbacks_release(ctx) before
+// freeing the context to drop the C callbacks still registered with native code.
+
+struct QJSFunctionRef {
+    JSContext* ctx;
+    JSValue fn;
+    std::thread::id owner = std::this_thread::get_id();
+    std::shared_ptr<QJSAsyncChannel> channel;
+    bool listener; // queued: counts as a listener of the runtime's event loop
+
+    QJSFunctionRef(JSContext* c, JSValueConst f, bool listen)
+        : ctx(JS_DupContext(c)), fn(JS_DupValue(c, f)), listener(listen) {
+        QJSAsyncState& st = qjs_async_state(JS_GetRuntime(c));
+        channel = st.channel;
+        if (listener) st.add_listener();
+    }
+    QJSFunctionRef(const QJSFunctionRef&) = delete;
+    QJSFunctionRef& operator=(const QJSFunctionRef&) = delete;
+
+    static void release(JSContext* ctx, JSValue fn, bool listener) {
+        if (listener) {
+            QJSRuntimeState* state = QJSRuntimeState::find(JS_GetRuntime(ctx));
+            if (QJSAsyncState* st = state ? state->find_slot<QJSAsyncState>() : nullptr) st->remove_listener();
+        }
+        JS_FreeValue(ctx, fn);
+        JS_FreeContext(ctx);
+    }
+
+    ~QJSFunctionRef() {
+        {
+            std::lock_guard<std::mutex> lock(channel->mu);
+            if (channel->closed) return; // the runtime is being freed
+        }
+        if (std::this_thread::get_id() == owner) release(ctx, fn, listener);
+        else channel->post([c = ctx, f = fn, l = listener] { release(c, f, l); });
+    }
+
+    // JS thread only. Consumes `argv`; on a JS exception returns JS_EXCEPTION with the
+    // exception left pending.
+    JSValue call(int argc, JSValue* argv) const {
+        JSValue r = JS_Call(ctx, fn, JS_UNDEFINED, argc, argv);
+        for (int i = 0; i < argc; ++i) JS_FreeValue(ctx, argv[i]);
+        return r;
+    }
+};
+
+// Callback arguments: struct pointers are lent to JS, never adopted.
+template<typename T>
+JSValue qjs_callback_value(JSContext* ctx, T&& v) {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_pointer_v<D> && std::is_class_v<std::remove_cv_t<std::remove_pointer_t<D>>>)
+        return cpp_to_js(ctx, qjs_borrow(v));
+    else
+        return cpp_to_js(ctx, D(std::forward<T>(v)));
+}
+
+inline void qjs_report_callback_exception(JSContext* ctx) {
+    JSValue exc = JS_GetException(ctx);
+    const char* msg = JS_ToCString(ctx, exc);
+    std::cerr << "Uncaught exception in callback: " << (msg ? msg : "exception") << std::endl;
+    JS_FreeCString(ctx, msg);
+    JS_FreeValue(ctx, exc);
+}
+
+template<typename R, typename... A>
+class QJSFunction<R(A...)> {
+    std::shared_ptr<QJSFunctionRef> ref_;
+
+public:
+    QJSFunction() = default;
+    QJSFunction(JSContext* ctx, JSValueConst fn) {
+        if (JS_IsFunction(ctx, fn)) ref_ = std::make_shared<QJSFunctionRef>(ctx, fn, false);
+    }
+
+    explicit operator bool() const { return ref_ != nullptr; }
+
+    // JS thread only. Throws QJSPendingException when the JS function throws; in
+    // QJS_NO_EXCEPTIONS mode returns R() and leaves the exception to QJSCallbackScope.
+    R operator()(A... args) const {
+        if (!ref_) return R();
+#ifdef QJS_NO_EXCEPTIONS
+        if (QJSCallbackScope::failed()) return R(); // an earlier call of this binding threw
+#endif
+        JSContext* ctx = ref_->ctx;
+        JSValue argv[sizeof...(A) + 1] = {qjs_callback_value(ctx, static_cast<A&&>(args))...};
+        JSValue r = ref_->call(static_cast<int>(sizeof...(A)), argv);
+        if (JS_IsException(r)) {
+#ifdef QJS_NO_EXCEPTIONS
+            if (!QJSCallbackScope::capture()) qjs_report_callback_exception(ctx);
+            return R();
+#else
+            throw QJSPendingException{};
+#endif
+        }
+        if constexpr (std::is_void_v<R>) {
+            JS_FreeValue(ctx, r);
+        } else {
+            R out = js_to_cpp<std::decay_t<R>>(ctx, r);
+            JS_FreeValue(ctx, r);
+            return out;
+        }
+    }
+};
+
+// Events of one queued callback, appended from any thread and delivered as one batch.
+template<typename... E>
+struct QJSEventQueue {
+    using value_type_tuple = std::tuple<E...>;
+
+    std::shared_ptr<QJSFunctionRef> ref;
+    size_t skip; // argument not passed to JS (a C callback's user data), SIZE_MAX for none
+    std::mutex mu;
+    std::vector<std::tuple<E...>> events;
+    bool scheduled = false;
+
+    explicit QJSEventQueue(std::shared_ptr<QJSFunctionRef> r, size_t skip_index = SIZE_MAX)
+        : ref(std::move(r)), skip(skip_index) {}
+
+    static void push(const std::shared_ptr<QJSEventQueue>& q, std::tuple<E...> event) {
+        std::lock_guard<std::mutex> lock(q->mu);
+        q->events.push_back(std::move(event));
+        if (!q->scheduled) q->scheduled = q->ref->channel->post([q] { q->drain(); });
+    }
+
+    template<std::size_t... Is>
+    JSValue event_to_js(JSContext* ctx, std::tuple<E...>& e, std::index_sequence<Is...>) const {
+        JSValue args = JS_NewArray(ctx);
+        uint32_t n = 0;
+        ((Is != skip ? (void)JS_SetPropertyUint32(ctx, args, n++, qjs_callback_value(ctx, std::move(std::get<Is>(e))))
+                     : void()), ...);
+        return args;
+    }
+
+    // JS thread.
+    void drain() {
+        std::vector<std::tuple<E...>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            batch.swap(events);
+            scheduled = false;
+        }
+        if (batch.empty()) return;
+        JSContext* ctx = ref->ctx;
+        JSValue list = JS_NewArray(ctx);
+        for (size_t i = 0; i < batch.size(); ++i)
+            JS_SetPropertyUint32(ctx, list, static_cast<uint32_t>(i),
+                                 event_to_js(ctx, batch[i], std::index_sequence_for<E...>{}));
+        JSValue r = ref->call(1, &list);
+        if (JS_IsException(r)) qjs_report_callback_exception(ctx);
+        JS_FreeValue(ctx, r);
+    }
+};
+
+template<typename... A>
+class QJSQueuedFunction<void(A...)> {
+    using Queue = QJSEventQueue<typename QJSAsyncOwned<std::decay_t<A>>::type...>;
+    std::shared_ptr<Queue> queue_;
+
+public:
+    QJSQueuedFunction() = default;
+    QJSQueuedFunction(JSContext* ctx, JSValueConst fn) {
+        if (JS_IsFunction(ctx, fn)) queue_ = std::make_shared<Queue>(std::make_shared<QJSFunctionRef>(ctx, fn, true));
+    }
+
+    explicit operator bool() const { return queue_ != nullptr; }
+
+    // Any thread.
+    void operator()(A... args) const {
+        if (queue_) Queue::push(queue_, typename Queue::value_type_tuple(static_cast<A&&>(args)...));
+    }
+};
+
+// C callbacks registered with native code, kept per runtime until released.
+struct QJSCallbackSlots : QJSRuntimeSlot {
+    struct Kept {
+        const void* type; // QJSCallbackArg instantiation, so a reused holder has the right type
+        const void* fn;   // identity of the JS function
+        std::shared_ptr<void> holder;
+    };
+    std::shared_ptr<QJSAsyncChannel> channel;
+    // Keyed by the generated adapter's slot name: its address, not its contents
+    std::unordered_map<const char*, std::vector<Kept>> kept;
+
+    ~QJSCallbackSlots() override {
+        // Still registered at runtime teardown: the references must not touch the runtime.
+        if (!channel) return;
+        std::lock_guard<std::mutex> lock(channel->mu);
+        channel->closed = true;
+    }
+};
+
+// Keeps `holder`, a registration of `fn` through slot `key`, and returns the user data to hand
+// to native code. Native code may still hold every earlier registration (one add_event_cb per
+// object), so nothing is replaced: registering the same function again through the same slot
+// reuses its holder, and everything stays alive until `key` is registered with null
+// (`holder` empty) or qjs_callbacks_release().
+inline void* qjs_keep_callback(JSContext* ctx, const char* key, const void* type, const void* fn,
+                               std::shared_ptr<void> holder) {
+    JSRuntime* rt = JS_GetRuntime(ctx);
+    QJSCallbackSlots& slots = QJSRuntimeState::get(rt).slot<QJSCallbackSlots>();
+    if (!slots.channel) slots.channel = qjs_async_state(rt).channel;
+    if (!holder) {
+        auto it = slots.kept.find(key);
+        if (it == slots.kept.end()) return nullptr;
+        std::vector<QJSCallbackSlots::Kept> released = std::move(it->second);
+        slots.kept.erase(it);
+        return nullptr;
+    }
+    std::vector<QJSCallbackSlots::Kept>& kept = slots.kept[key];
+    for (const auto& k : kept)
+        if (k.type == type && k.fn == fn) return k.holder.get();
+    kept.push_back({type, fn, holder});
+    return holder.get();
+}
+
+// Number of C callback registrations this runtime keeps past their call (retained / queued).
+inline size_t qjs_callbacks_kept(JSContext* ctx) {
+    QJSRuntimeState* state = QJSRuntimeState::find(JS_GetRuntime(ctx));
+    QJSCallbackSlots* slots = state ? state->find_slot<QJSCallbackSlots>() : nullptr;
+    size_t n = 0;
+    if (slots)
+        for (const auto& [key, kept] : slots->kept) n += kept.size();
+    return n;
+}
+
+// Drops every C callback still registered from this runtime and runs deferred releases.
+inline void qjs_callbacks_release(JSContext* ctx) {
+    QJSRuntimeState* state = QJSRuntimeState::find(JS_GetRuntime(ctx));
+    QJSCallbackSlots* slots = state ? state->find_slot<QJSCallbackSlots>() : nullptr;
+    if (slots) {
+        auto kept = std::move(slots->kept);
+        slots->kept.clear();
+    }
+    qjs_async_poll(ctx);
+}
+
+// A JS function passed where a C API expects `Fp` plus a `void*` user-data argument. The
+// generated adapter passes function() and user_data(); the trampoline finds its JS
+// function through the user data, which is the last `void*` parameter of Fp.
+template<typename R, typename... A, bool Queued>
+class QJSCallbackArg<R (*)(A...), Queued> {
+    static constexpr size_t user_index() {
+        size_t idx = SIZE_MAX, i = 0;
+        ((idx = std::is_same_v<A, void*> ? i : idx, ++i), ...);
+        return idx;
+    }
+    static constexpr size_t kUser = user_index();
+    static_assert(kUser != SIZE_MAX, "C callbacks need a void* user-data parameter");
+    static_assert(!Queued || std::is_void_v<R>, "queued callbacks cannot return a value");
+
+    using Queue = QJSEventQueue<typename QJSAsyncOwned<std::decay_t<A>>::type...>;
+    struct Holder {
+        std::shared_ptr<QJSFunctionRef> ref;
+        std::shared_ptr<Queue> queue; // queued mode
+    };
+
+    JSContext* ctx_ = nullptr;
+    std::shared_ptr<Holder> holder_;
+    static constexpr char tag_ = 0; // its address identifies the Holder type in QJSCallbackSlots
+
+    template<std::size_t... Is>
+    static int to_js(JSContext* ctx, JSValue* argv, std::index_sequence<Is...>, A... args) {
+        int n = 0;
+        ((Is != kUser ? (void)(argv[n++] = qjs_callback_value(ctx, static_cast<A&&>(args))) : void()), ...);
+        return n;
+    }
+
+    static R trampoline(A... args) {
+        auto* h = static_cast<Holder*>(std::get<kUser>(std::tuple<A...>(args...)));
+        if constexpr (Queued) {
+            Queue::push(h->queue, typename Queue::value_type_tuple(static_cast<A&&>(args)...));
+        } else {
+            if (QJSCallbackScope::failed()) return R(); // an earlier callback of this call threw
+            JSContext* ctx = h->ref->ctx;
+            JSValue argv[sizeof...(A)];
+            int argc = to_js(ctx, argv, std::index_sequence_for<A...>{}, static_cast<A&&>(args)...);
+            JSValue r = h->ref->call(argc, argv);
+            if (JS_IsException(r)) {
+                if (!QJSCallbackScope::capture()) qjs_report_callback_exception(ctx);
+                return R();
+            }
+            if constexpr (std::is_void_v<R>) {
+                JS_FreeValue(ctx, r);
+            } else {
+                R out = js_to_cpp<std::decay_t<R>>(ctx, r);
+                JS_FreeValue(ctx, r);
+                return out;
+            }
+        }
+    }
+
+public:
+    using pointer = R (*)(A...);
+
+    QJSCallbackArg() = default;
+    QJSCallbackArg(JSContext* ctx, JSValueConst fn) : ctx_(ctx) {
+        if (!JS_IsFunction(ctx, fn)) return;
+        holder_ = std::make_shared<Holder>();
+        holder_->ref = std::make_shared<QJSFunctionRef>(ctx, fn, Queued);
+        if constexpr (Queued) holder_->queue = std::make_shared<Queue>(holder_->ref, kUser);
+    }
+
+    // Null when JS passed null / undefined.
+    pointer function() const { return holder_ ? &trampoline : nullptr; }
+
+    // Direct callback: alive as long as this argument, i.e. for the bound call.
+    void* user_data() const { return holder_.get(); }
+
+    // Retained / queued callback: kept in slot `key` (a static of the generated adapter, one
+    // per function and parameter) until null is passed through the same parameter or
+    // qjs_callbacks_release().
+    void* user_data(const char* key) const {
+        if (!ctx_) return holder_.get();
+        return qjs_keep_callback(ctx_, key, &tag_, holder_ ? JS_VALUE_GET_PTR(holder_->ref->fn) : nullptr, holder_);
+    }
+};
+
+// --- 11. Field Tables ---
+// Each generated struct lists its bound fields once, in a constexpr QJSFieldDesc table, and
+// registers every field with JS_CGETSET_MAGIC_DEF(name, get, set, index) against the one
+// QJSFieldAccess<S, Table> pair. The member pointer is a template argument, so a field costs
+// a small conversion function instead of a full accessor body; unwrapping, profiling and
+// validation exist once per struct. toObject(), snapshot() and assign() loop over the same
+// table, so bulk and per-field access cannot diverge.
+
+template<auto Member>
+struct QJSMember;
+
+template<typename S, typename M, M S::*Member>
+struct QJSMember<Member> {
+    using type = M;
+
+    // `self` is the JS object wrapping `obj`
+    static JSValue get(JSContext* ctx, JSValueConst self, const void* obj) {
+        const M& v = static_cast<const S*>(obj)->*Member;
+        // Pointer members belong to the struct, never to the JS wrapper
+        if constexpr (std::is_pointer_v<M> && std::is_class_v<std::remove_cv_t<std::remove_pointer_t<M>>>) {
+            using E = std::remove_cv_t<std::remove_pointer_t<M>>;
+            if (JSClassIdTraits<E>::id != 0) return cpp_to_js(ctx, qjs_borrow(v));
+        }
+        // Bound struct members are views into the parent: no copy, writes land in `obj`
+        if constexpr (std::is_class_v<M>) {
+            if (JSClassIdTraits<M>::id != 0) return qjs_wrap_ref<M>(ctx, const_cast<M*>(&v), {}, self);
+        }
+        return cpp_to_js(ctx, v);
+    }
+
+    static void set(JSContext* ctx, void* obj, JSValueConst val) {
+        M& field = static_cast<S*>(obj)->*Member;
+        // A bound struct member takes another instance (copied) or a plain object, whose
+        // properties go through the member's own field table; anything else is a TypeError
+        // instead of a value-initialised struct (QJS_NO_EXCEPTIONS rejected it already)
+        if constexpr (std::is_class_v<M>) {
+            if (JSClassIdTraits<M>::id != 0 && !JS_GetOpaque(val, JSClassIdTraits<M>::id)) {
+#ifndef QJS_NO_EXCEPTIONS
+                auto assign = JSClassIdTraits<M>::assign;
+                if (!JS_IsObject(val) || !assign) {
+                    JS_ThrowTypeError(ctx, "expected %s", qjs_type_name<M>().c_str());
+                    throw QJSPendingException{};
+                }
+                if (JS_IsException(assign(ctx, &field, val))) throw QJSPendingException{};
+#endif
+                return;
+            }
+        }
+        field = js_to_cpp<M>(ctx, val);
+    }
+
+    // snapshot(): like get, but a bound struct member is copied into its own JS object
+    static JSValue copy(JSContext* ctx, JSValueConst self, const void* obj) {
+        if constexpr (std::is_class_v<M>) {
+            if (JSClassIdTraits<M>::id != 0) return cpp_to_js(ctx, static_cast<const S*>(obj)->*Member);
+        }
+        return get(ctx, self, obj);
+    }
+};
+
+struct QJSFieldDesc {
+    const char* name;
+    uint32_t atom; // index of `name` in the generated module's atom table
+    JSValue (*get)(JSContext*, JSValueConst, const void*);
+    void (*set)(JSContext*, void*, JSValueConst);
+    JSValue (*copy)(JSContext*, JSValueConst, const void*);
+    // Type check of the member type, shared by all fields of that type (QJS_NO_EXCEPTIONS)
+    const char* (*mismatch)(JSContext*, JSValueConst);
+};
+
+template<auto Member>
+constexpr QJSFieldDesc qjs_field(const char* name, uint32_t atom) {
+#ifdef QJS_NO_EXCEPTIONS
+    return {name, atom, &QJSMember<Member>::get, &QJSMember<Member>::set, &QJSMember<Member>::copy,
+            &qjs_arg_mismatch<typename QJSMember<Member>::type>};
+#else
+    return {name, atom, &QJSMember<Member>::get, &QJSMember<Member>::set, &QJSMember<Member>::copy, nullptr};
+#endif
+}
+
+// Bit-fields have no member pointer: the generator emits the two conversions of a field of type M
+template<typename M>
+constexpr QJSFieldDesc qjs_field(const char* name, uint32_t atom, JSValue (*get)(JSContext*, JSValueConst, const void*),
+                                 void (*set)(JSContext*, void*, JSValueConst)) {
+#ifdef QJS_NO_EXCEPTIONS
+    return {name, atom, get, set, get, &qjs_arg_mismatch<M>};
+#else
+    return {name, atom, get, set, get, nullptr};
+#endif
+}
+
+template<typename S, const auto& Fields>
+struct QJSFieldAccess {
+    static constexpr size_t count = std::extent_v<std::remove_reference_t<decltype(Fields)>>;
+
+#ifdef QJS_PROFILE_BINDING
+    // "<Struct>.get <field>" / "<Struct>.set <field>", registered on first use
+    static uint32_t site(int magic, bool setter) {
+        static const std::vector<uint32_t> sites = [] {
+            std::vector<uint32_t> v;
+            for (size_t i = 0; i < count; ++i) {
+                v.push_back(QJSProfiler::site(qjs_type_name<S>() + ".get " + Fields[i].name));
+                v.push_back(QJSProfiler::site(qjs_type_name<S>() + ".set " + Fields[i].name));
+            }
+            return v;
+        }();
+        return sites[2 * magic + setter];
+    }
+#endif
+
+    static JSValue get(JSContext* ctx, JSValueConst this_val, int magic) {
+#ifdef QJS_PROFILE_BINDING
+        QJSProfileScope prof(site(magic, false), &QJSProfileCounters::ret);
+#endif
+        S* obj = qjs_unwrap<S>(this_val);
+        if (!obj) return JS_EXCEPTION;
+        return Fields[magic].get(ctx, this_val, obj);
+    }
+
+    static JSValue set(JSContext* ctx, JSValueConst this_val, JSValueConst val, int magic) {
+#ifdef QJS_PROFILE_BINDING
+        QJSProfileScope prof(site(magic, true), &QJSProfileCounters::args);
+#endif
+        S* obj = qjs_unwrap<S>(this_val);
+        if (!obj) return JS_EXCEPTION;
+        return store(ctx, obj, Fields[magic], val);
+    }
+
+    // assign(values): every field present on `values`, through the same checks as the setters.
+    static JSValue assign(JSContext* ctx, JSValueConst this_val, JSValueConst values, const JSAtom* atoms) {
+        S* obj = qjs_unwrap<S>(this_val);
+        if (!obj) return JS_EXCEPTION;
+        if (!JS_IsObject(values)) {
+            return JS_ThrowTypeError(ctx, "%s.assign: expected an object", qjs_type_name<S>().c_str());
+        }
+        JSValue r = assign_into(ctx, obj, values, atoms);
+        return JS_IsException(r) ? r : JS_DupValue(ctx, this_val);
+    }
+
+    // The loop of assign() on a raw S*, also behind JSClassIdTraits<S>::assign (nested members).
+    static JSValue assign_into(JSContext* ctx, S* obj, JSValueConst values, const JSAtom* atoms) {
+        for (size_t i = 0; i < count; ++i) {
+            JSValue v = JS_GetProperty(ctx, values, atoms[Fields[i].atom]);
+            if (JS_IsException(v)) return v;
+            JSValue r = JS_IsUndefined(v) ? JS_UNDEFINED : store(ctx, obj, Fields[i], v);
+            JS_FreeValue(ctx, v);
+            if (JS_IsException(r)) return r;
+        }
+        return JS_UNDEFINED;
+    }
+
+    static JSValue store(JSContext* ctx, S* obj, const QJSFieldDesc& f, JSValueConst val) {
+#ifdef QJS_NO_EXCEPTIONS
+        if (const char* expected = f.mismatch(ctx, val)) {
+            return JS_ThrowTypeError(ctx, "%s.%s: expected %s", qjs_type_name<S>().c_str(), f.name, expected);
+        }
+#endif
+        // Buffer / TypedArray and shared_ptr fields throw a pending TypeError on a mismatch
+        return qjs_call_boundary<>(ctx, [&] {
+            f.set(ctx, obj, val);
+            return JS_UNDEFINED;
+        });
+    }
+
+    // toObject(): every field through its getter, so pointer members stay borrowed and nested
+    // structs are views, exactly as `obj.field` returns them. snapshot() (`copy`) copies
+    // nested structs instead, so later writes to this object do not show through.
+    static JSValue to_object(JSContext* ctx, JSValueConst this_val, const JSAtom* atoms, bool copy = false) {
+        S* obj = qjs_unwrap<S>(this_val);
+        if (!obj) return JS_EXCEPTION;
+        JSValue o = JS_NewObject(ctx);
+        if (JS_IsException(o)) return o;
+        for (size_t i = 0; i < count; ++i) {
+            JSValue v = (copy ? Fields[i].copy : Fields[i].get)(ctx, this_val, obj);
+            if (JS_IsException(v) || JS_DefinePropertyValue(ctx, o, atoms[Fields[i].atom], v, JS_PROP_C_W_E) < 0) {
+                JS_FreeValue(ctx, o);
+                return JS_EXCEPTION;
+            }
+        }
+        return o;
+    }
+};
@@ -0,0 +1,149 @@
+// Measures calls/sec through Wrapper<Func>::call for int, double, bool, string and struct
+// pointer signatures, both called directly from C++ (conversion cost only) and from a JS
+// loop, plus a call whose first argument has the wrong type (coerced by default, a
+// TypeError in QJS_NO_EXCEPTIONS mode).
+//
+// Usage: qjs_wrapper_bench [iterations=10000000]
+// Build once normally and once with --copt=-DQJS_DISABLE_FAST_PATH to compare the
+// tag-switch fast paths against the generic JS_To* conversions; qjs_wrapper_bench_noexcept
+// is the same benchmark built with -fno-exceptions.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "qjs_utils.hpp"
+
+namespace
+{
+  int bench_add_int(int a, int b) { return a + b; }
+  double bench_mul_double(double a, double b) { return a * b; }
+  bool bench_not_bool(bool v) { return !v; }
+  int bench_len_string(const std::string& s) { return static_cast<int>(s.size()); }
+
+  struct BenchObj
+  {
+    int value;
+  };
+  int bench_touch_obj(BenchObj* o, int v) { return o ? o->value += v : 0; }
+
+  volatile int64_t sink = 0;
+
+  double seconds_since(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // Calls the wrapper with pre-built arguments: no interpreter in the loop.
+  template <auto Func>
+  double direct_rate(JSContext* ctx, JSValueConst* argv, int argc, int64_t iterations)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      JSValue r = Wrapper<Func>::call(ctx, JS_UNDEFINED, argc, argv);
+      sink += JS_VALUE_GET_TAG(r);
+      if (JS_IsException(r)) JS_FreeValue(ctx, JS_GetException(ctx));
+      JS_FreeValue(ctx, r);
+    }
+    return iterations / seconds_since(start);
+  }
+
+  // Calls the wrapper from a JS loop; includes interpreter dispatch. `guarded` wraps each
+  // call in try/catch for calls that may throw.
+  double js_rate(JSContext* ctx, const char* name, JSCFunction* fn, int length, const std::string& callExpr,
+                 int64_t iterations, bool guarded = false)
+  {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JS_SetPropertyStr(ctx, global, name, JS_NewCFunction(ctx, fn, name, length));
+    JS_FreeValue(ctx, global);
+
+    std::string body = "s += " + callExpr + ";";
+    if (guarded) body = "try { " + body + " } catch (e) { s++; }";
+    std::string script = "(function(n){ let s = 0; for (let i = 0; i < n; i++) { " + body + " } return s; })(" +
+      std::to_string(iterations) + ")";
+    auto start = std::chrono::steady_clock::now();
+    JSValue r = JS_Eval(ctx, script.c_str(), script.size(), "<bench>", JS_EVAL_TYPE_GLOBAL);
+    double secs = seconds_since(start);
+    if (JS_IsException(r))
+    {
+      JSValue exc = JS_GetException(ctx);
+      const char* msg = JS_ToCString(ctx, exc);
+      std::fprintf(stderr, "%s: %s\n", name, msg ? msg : "exception");
+      JS_FreeCString(ctx, msg);
+      JS_FreeValue(ctx, exc);
+    }
+    JS_FreeValue(ctx, r);
+    return iterations / secs;
+  }
+
+  void report(const char* signature, double direct, double js)
+  {
+    std::printf("%-28s direct %8.2f Mcalls/s   js %8.2f Mcalls/s\n", signature, direct / 1e6, js / 1e6);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int64_t iterations = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : 10000000;
+
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+#ifdef QJS_DISABLE_FAST_PATH
+  std::printf("fast path: off, %lld iterations\n", static_cast<long long>(iterations));
+#else
+  std::printf("fast path: on, %lld iterations\n", static_cast<long long>(iterations));
+#endif
+#ifdef QJS_NO_EXCEPTIONS
+  std::printf("exceptions: off (QJS_NO_EXCEPTIONS)\n");
+#else
+  std::printf("exceptions: on\n");
+#endif
+
+  JSValue ints[] = {JS_NewInt32(ctx, 20), JS_NewInt32(ctx, 22)};
+  report("int(int, int)", direct_rate<bench_add_int>(ctx, ints, 2, iterations),
+         js_rate(ctx, "bench_add_int", Wrapper<bench_add_int>::call, 2, "bench_add_int(i, 1)", iterations));
+
+  JSValue doubles[] = {JS_NewFloat64(ctx, 1.5), JS_NewFloat64(ctx, 2.25)};
+  report("double(double, double)", direct_rate<bench_mul_double>(ctx, doubles, 2, iterations),
+         js_rate(ctx, "bench_mul_double", Wrapper<bench_mul_double>::call, 2, "bench_mul_double(i * 0.5, 1.5)",
+                 iterations));
+
+  JSValue bools[] = {JS_NewBool(ctx, true)};
+  report("bool(bool)", direct_rate<bench_not_bool>(ctx, bools, 1, iterations),
+         js_rate(ctx, "bench_not_bool", Wrapper<bench_not_bool>::call, 1, "bench_not_bool((i & 1) === 0)",
+                 iterations));
+
+  JSValue strings[] = {JS_NewString(ctx, "the quick brown fox")};
+  report("int(const std::string&)", direct_rate<bench_len_string>(ctx, strings, 1, iterations),
+         js_rate(ctx, "bench_len_string", Wrapper<bench_len_string>::call, 1, "bench_len_string('the quick brown fox')",
+                 iterations));
+  JS_FreeValue(ctx, strings[0]);
+
+  // Borrowed object: no finalizer, the C++ side owns `obj`
+  static BenchObj obj{0};
+  JSClassID objClass = qjs_class_id<BenchObj>(rt);
+  JSClassDef objDef = {"BenchObj"};
+  qjs_register_class(ctx, objClass, &objDef);
+  JS_SetClassProto(ctx, objClass, JS_NewObject(ctx));
+  JSValue objArgs[] = {JS_NewObjectClass(ctx, objClass), JS_NewInt32(ctx, 1)};
+  JS_SetOpaque(objArgs[0], &obj);
+  JSValue global = JS_GetGlobalObject(ctx);
+  JS_SetPropertyStr(ctx, global, "benchObj", JS_DupValue(ctx, objArgs[0]));
+  JS_FreeValue(ctx, global);
+  report("int(BenchObj*, int)", direct_rate<bench_touch_obj>(ctx, objArgs, 2, iterations),
+         js_rate(ctx, "bench_touch_obj", Wrapper<bench_touch_obj>::call, 2, "bench_touch_obj(benchObj, 1)",
+                 iterations));
+
+  // Error path: a number where BenchObj* is expected
+  JSValue badArgs[] = {JS_NewInt32(ctx, 42), JS_NewInt32(ctx, 1)};
+  report("mismatched arg", direct_rate<bench_touch_obj>(ctx, badArgs, 2, iterations),
+         js_rate(ctx, "bench_touch_obj", Wrapper<bench_touch_obj>::call, 2, "bench_touch_obj(42, 1)", iterations,
+                 true));
+  JS_FreeValue(ctx, objArgs[0]);
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+  return 0;
+}